@@ -1,13 +1,27 @@
-﻿#ifndef 5Z_H 
-#define 5Z_H 
+﻿#ifndef PRIORITY_QUEUE_5Z_H 
+#define PRIORITY_QUEUE_5Z_H 
+#include <string>
+#include <utility>
+#include <vector>
 class priority_queue {
 public:
 	virtual void add_value(const char* str, int priority) = 0; 
-	virtual char* search_value() const = 0;
+	virtual const char* search_value() const = 0;
 	virtual void delete_value() = 0;
+	// Без исключений для пустой очереди: false, если она пуста, иначе вершина
+	// записывается в аргументы; try_pop ещё и удаляет её, строка копируется в str
+	virtual bool try_peek(const char*& str, int& priority) const = 0;
+	virtual bool try_pop(std::string& str, int& priority) = 0;
+	virtual int size() const = 0;
+	// Забирает до count элементов с вершины в порядке извлечения и дописывает их в out;
+	// возвращает число забранных. Пустая очередь - не ошибка
+	virtual int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) = 0;
+	// То же без удаления: до count старших элементов в порядке извлечения
+	virtual int top_k(int count, std::vector<std::pair<std::string, int>>& out) const = 0;
 	virtual priority_queue& merge(const priority_queue& second) = 0;
-	virtual ~priority_queue() noexept = default;
+	virtual priority_queue& merge(priority_queue&& second) = 0; // забирает узлы донора, оставляя его пустым
+	virtual ~priority_queue() noexcept = default;
 };
 
-#endif //5Z_H
+#endif //PRIORITY_QUEUE_5Z_H
 
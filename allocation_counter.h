@@ -0,0 +1,36 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Глобальные operator new/delete со счётчиком выделений для замеров в демонстрациях
+// и бенчмарках. Подключается один раз на программу; у каждого потока свой счётчик
+static thread_local long long allocation_count = 0;
+
+// GCC принимает free в заменённом operator delete за несоответствие operator new
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif //ALLOCATION_COUNTER_H
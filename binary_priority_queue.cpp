@@ -1,94 +1,163 @@
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
-#include "C:\Users\arnau\source\repos\second_sem_labs\priority_queue.h"
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "5z.h"
+#include "node_pool.h"
+#include "queue_snapshot.h"
 #pragma warning (disable: 4996)
 
-class binary_priority_queue final : public priority_queue {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Двоичная куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Значения перемещаются в массив и из него;
+// T и Priority должны конструироваться по умолчанию (массив выделяется заранее)
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_binary_priority_queue {
     struct node {
-        int priority;
-        char* value;
+        Priority priority;
+        T value;
 
-        node() : priority(0), value(nullptr) {}
-
-        node(int p, const char* str) : priority(p), value(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                std::strcpy(value, str);
-            }
+        void clear() {
+            priority = Priority();
+            value = T();
         }
+    };
 
-        node(const node& other) : priority(other.priority), value(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
-            }
-        }
+public:
+    // fixed - ёмкость задаётся один раз, переполнение - ошибка
+    // growable - ёмкость удваивается при заполнении
+    // elastic - как growable, но после опустошения буфер ужимается
+    enum class capacity_policy { fixed, growable, elastic };
 
-        node& operator=(const node& other) {
-            if (this != &other) {
-                delete[] value;
-                priority = other.priority;
-                value = nullptr;
-                if (other.value) {
-                    value = new char[std::strlen(other.value) + 1];
-                    std::strcpy(value, other.value);
-                }
-            }
-            return *this;
-        }
+private:
+    node* heap;
+    int current_size;
+    int max_size;
+    capacity_policy policy;
+    Compare compare;
 
-        ~node() {
-            delete[] value;
+    // Переносит элементы в буфер новой ёмкости перемещением, без копирования строк
+    void relocate(int new_capacity) {
+        node* new_heap = new_capacity > 0 ? new node[new_capacity] : nullptr;
+        for (int i = 0; i < current_size; ++i) {
+            new_heap[i] = std::move(heap[i]);
         }
+        delete[] heap;
+        heap = new_heap;
+        max_size = new_capacity;
+    }
 
-        void clear() {
-            delete[] value;
-            value = nullptr;
-            priority = 0;
+    void ensure_capacity(int required) {
+        if (required <= max_size) return;
+        if (policy == capacity_policy::fixed) throw "Queue is full";
+
+        int new_capacity = max_size > 0 ? max_size : 1;
+        while (new_capacity < required) {
+            new_capacity *= 2;
         }
-    };
+        relocate(new_capacity);
+    }
 
-    node* heap;
-    int current_size;
-    int max_size;
+    void shrink_after_drain() {
+        if (policy != capacity_policy::elastic) return;
 
-private:
+        if (current_size == 0) {
+            relocate(0);
+        }
+        else if (current_size <= max_size / 4) {
+            relocate(max_size / 2);
+        }
+    }
+
+    // Просеивание "дыркой": поднимаемый элемент перемещается один раз,
+    // остальные сдвигаются на его место без обменов и копирования строк
     void heapify_up(int index) {
+        node moving = std::move(heap[index]);
+
         while (index > 0) {
             int parent = (index - 1) / 2;
-            if (heap[parent].priority >= heap[index].priority)
+            if (!compare(heap[parent].priority, moving.priority))
                 break;
-            swap_nodes(parent, index);
+            heap[index] = std::move(heap[parent]);
             index = parent;
         }
+
+        heap[index] = std::move(moving);
     }
 
     void heapify_down(int index) {
+        node moving = std::move(heap[index]);
+
         while (true) {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int largest = index;
+            int largest = 2 * index + 1;
+            if (largest >= current_size)
+                break;
 
-            if (left < current_size && heap[left].priority > heap[largest].priority)
-                largest = left;
-            if (right < current_size && heap[right].priority > heap[largest].priority)
+            int right = largest + 1;
+            if (right < current_size && compare(heap[largest].priority, heap[right].priority))
                 largest = right;
 
-            if (largest == index)
+            if (!compare(moving.priority, heap[largest].priority))
                 break;
 
-            swap_nodes(index, largest);
+            heap[index] = std::move(heap[largest]);
             index = largest;
         }
+
+        heap[index] = std::move(moving);
+    }
+
+    // Построение кучи снизу вверх (алгоритм Флойда) за O(n)
+    void build_heap() {
+        for (int i = current_size / 2 - 1; i >= 0; --i) {
+            heapify_down(i);
+        }
+    }
+
+    // Восстанавливает кучу после дописывания элементов с позиции first_appended:
+    // поштучный подъём стоит ~m*log(n), перестройка - ~2n, выбираем дешёвое
+    void restore_after_append(int first_appended) {
+        int appended = current_size - first_appended;
+        if (appended <= 0) return;
+
+        int levels = 0;
+        for (int size = current_size; size > 1; size /= 2) {
+            ++levels;
+        }
+
+        if (static_cast<long long>(appended) * levels > 2LL * current_size) {
+            build_heap();
+        }
+        else {
+            for (int i = first_appended; i < current_size; ++i) {
+                heapify_up(i);
+            }
+        }
     }
 
-    void swap_nodes(int first, int second) {
-        node temp = heap[first];
-        heap[first] = heap[second];
-        heap[second] = temp;
+    void append_copies(const basic_binary_priority_queue& source, int count) {
+        for (int i = 0; i < count; ++i) {
+            heap[current_size++] = source.heap[i];
+        }
     }
 
-    void swap_queues(binary_priority_queue& other) noexcept {
+    void swap_queues(basic_binary_priority_queue& other) noexcept {
         node* temp_heap = heap;
         heap = other.heap;
         other.heap = temp_heap;
@@ -100,57 +169,159 @@ private:
         int temp_max = max_size;
         max_size = other.max_size;
         other.max_size = temp_max;
+
+        capacity_policy temp_policy = policy;
+        policy = other.policy;
+        other.policy = temp_policy;
+
+        std::swap(compare, other.compare);
+    }
+
+protected:
+    // Массовая загрузка: элементы дописываются без упорядочивания,
+    // затем finish_bulk_load строит кучу за O(n)
+    template <typename Value>
+    void append_unordered(Value&& value, const Priority& priority) {
+        ensure_capacity(current_size + 1);
+        heap[current_size].priority = priority;
+        heap[current_size].value = std::forward<Value>(value);
+        current_size++;
+    }
+
+    template <typename InputIt>
+    void reserve_for_range(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            reserve(static_cast<int>(std::distance(first, last)));
+        }
+    }
+
+    void finish_bulk_load(capacity_policy capacity_mode) {
+        finish_ordered_load(capacity_mode);
+        build_heap();
+    }
+
+    // Проверка свойства кучи за O(n) без перемещений: пометке снимка не верим на слово
+    [[nodiscard]] bool holds_heap_order() const {
+        for (int i = 1; i < current_size; ++i) {
+            if (compare(heap[(i - 1) / 2].priority, heap[i].priority)) return false;
+        }
+        return true;
+    }
+
+    // Завершение загрузки элементов, уже лежащих в порядке кучи: перестройка не нужна
+    void finish_ordered_load(capacity_policy capacity_mode) {
+        policy = capacity_mode;
+        if (policy == capacity_policy::fixed && max_size == 0) {
+            throw "Invalid size: must be positive";
+        }
+    }
+
+    // Дописывает диапазон пар без упорядочивания и восстанавливает кучу один раз;
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        int first_appended = current_size;
+
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+            ensure_capacity(current_size + static_cast<int>(std::distance(first, last)));
+        }
+
+        try {
+            for (; first != last; ++first) {
+                append_unordered(make_value(first->first), first->second);
+            }
+        }
+        catch (...) {
+            restore_after_append(first_appended);
+            throw;
+        }
+        restore_after_append(first_appended);
     }
 
 public:
-    explicit binary_priority_queue(int initial_size)
+    explicit basic_binary_priority_queue(const Compare& order = Compare())
             : heap(nullptr),
               current_size(0),
-              max_size(initial_size) {
+              max_size(0),
+              policy(capacity_policy::growable),
+              compare(order) {
+    }
 
-        if (max_size <= 0) {
+    explicit basic_binary_priority_queue(int initial_size, capacity_policy capacity_mode = capacity_policy::fixed,
+                                         const Compare& order = Compare())
+            : heap(nullptr),
+              current_size(0),
+              max_size(initial_size),
+              policy(capacity_mode),
+              compare(order) {
+
+        if (max_size < 0 || (max_size == 0 && policy == capacity_policy::fixed)) {
             throw "Invalid size: must be positive";
         }
 
-        heap = new node[max_size];
+        if (max_size > 0) {
+            heap = new node[max_size];
+        }
+    }
+
+    // Массовая загрузка из диапазона пар (значение, приоритет) за O(n)
+    template <typename InputIt>
+    basic_binary_priority_queue(InputIt first, InputIt last, capacity_policy capacity_mode = capacity_policy::growable,
+                                const Compare& order = Compare())
+            : basic_binary_priority_queue(0, capacity_policy::growable, order) {
+        reserve_for_range(first, last);
+        for (; first != last; ++first) {
+            append_unordered(first->first, first->second);
+        }
+        finish_bulk_load(capacity_mode);
     }
 
-    binary_priority_queue(const binary_priority_queue& other)
+    basic_binary_priority_queue(const basic_binary_priority_queue& other)
             : heap(nullptr),
               current_size(other.current_size),
-              max_size(other.max_size) {
+              max_size(other.max_size),
+              policy(other.policy),
+              compare(other.compare) {
 
-        heap = new node[max_size];
+        if (max_size > 0) {
+            heap = new node[max_size];
+        }
 
         for (int i = 0; i < current_size; ++i) {
             heap[i] = other.heap[i];
         }
     }
 
-    binary_priority_queue& operator=(const binary_priority_queue& other) {
+    basic_binary_priority_queue& operator=(const basic_binary_priority_queue& other) {
         if (this != &other) {
-            binary_priority_queue temp(other);
+            basic_binary_priority_queue temp(other);
             swap_queues(temp);
         }
         return *this;
     }
 
-    binary_priority_queue(binary_priority_queue&& other) noexcept
+    basic_binary_priority_queue(basic_binary_priority_queue&& other) noexcept
             : heap(other.heap),
               current_size(other.current_size),
-              max_size(other.max_size) {
+              max_size(other.max_size),
+              policy(other.policy),
+              compare(other.compare) {
         other.heap = nullptr;
         other.current_size = 0;
         other.max_size = 0;
     }
 
-    binary_priority_queue& operator=(binary_priority_queue&& other) noexcept {
+    basic_binary_priority_queue& operator=(basic_binary_priority_queue&& other) noexcept {
         if (this != &other) {
             delete[] heap;
 
             heap = other.heap;
             current_size = other.current_size;
             max_size = other.max_size;
+            policy = other.policy;
+            compare = other.compare;
 
             other.heap = nullptr;
             other.current_size = 0;
@@ -159,16 +330,16 @@ public:
         return *this;
     }
 
-    ~binary_priority_queue() {
+    ~basic_binary_priority_queue() {
         delete[] heap;
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
-        if (is_full()) throw "Queue is full";
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        ensure_capacity(current_size + 1);
 
-        heap[current_size] = node(priority, str);
+        heap[current_size].priority = priority;
+        heap[current_size].value = std::forward<Value>(value);
 
         if (current_size > 0) {
             heapify_up(current_size);
@@ -176,79 +347,225 @@ public:
         current_size++;
     }
 
-    [[nodiscard]] const char* search_value() const override {
+    // Пакетная вставка: куча восстанавливается один раз подъёмами или перестройкой целиком
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    [[nodiscard]] const T& search_value() const {
         if (is_empty()) throw "Queue is empty";
         return heap[0].value;
     }
 
-    void delete_value() override {
+    [[nodiscard]] const Priority& search_priority() const {
         if (is_empty()) throw "Queue is empty";
+        return heap[0].priority;
+    }
 
-        heap[0].clear();
+    void delete_value() {
+        if (is_empty()) throw "Queue is empty";
 
         if (current_size == 1) {
+            heap[0].clear();
             current_size = 0;
         }
         else {
-            heap[0] = heap[current_size - 1];
-            heap[current_size - 1].clear();
+            heap[0] = std::move(heap[current_size - 1]);
             current_size--;
+            heapify_down(0);
+        }
+
+        shrink_after_drain();
+    }
+
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (is_empty()) throw "Queue is empty";
 
-            if (current_size > 0) {
+        T value = std::move(heap[0].value);
+        delete_value();
+        return value;
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число. Если забирается вся
+    // куча, массив один раз сортируется вместо поочерёдных просеиваний
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = count < current_size ? count : current_size;
+        if (taken > 1 && taken == current_size) {
+            std::sort(heap, heap + current_size, [this](const node& first, const node& second) {
+                return compare(second.priority, first.priority);
+            });
+
+            // Отсортированный остаток - тоже куча: при ошибке он сдвигается в начало
+            int i = 0;
+            try {
+                for (; i < taken; ++i) {
+                    consume(std::move(heap[i].value), heap[i].priority);
+                    heap[i].clear();
+                }
+            }
+            catch (...) {
+                std::move(heap + i, heap + current_size, heap);
+                current_size -= i;
+                throw;
+            }
+            current_size = 0;
+        }
+        else {
+            for (int i = 0; i < taken; ++i) {
+                consume(std::move(heap[0].value), heap[0].priority);
+                heap[0] = std::move(heap[current_size - 1]);
+                current_size--;
                 heapify_down(0);
             }
         }
+
+        shrink_after_drain();
+        return taken;
     }
 
-    priority_queue& merge(const priority_queue& second) override {
-        auto other_queue = dynamic_cast<const binary_priority_queue*>(&second);
+    // До count старших элементов без изменения кучи передаются visit(value, priority).
+    // Обход по фронту: в нём лежат дети уже выданных узлов, следующий - лучший из фронта,
+    // поэтому стоимость O(count log count) и не зависит от размера кучи
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](int first, int second) {
+            return compare(heap[first].priority, heap[second].priority);
+        };
+        std::vector<int> frontier;
+        if (count > 0 && current_size > 0) {
+            frontier.reserve(std::min<std::size_t>(count, current_size) + 1);
+            frontier.push_back(0);
+        }
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            int index = frontier.back();
+            frontier.pop_back();
+            visit(heap[index].value, heap[index].priority);
+            ++visited;
+
+            for (int child = 2 * index + 1; child <= 2 * index + 2 && child < current_size; ++child) {
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), lower);
+            }
         }
+        return visited;
+    }
+
+    basic_binary_priority_queue& merge(const basic_binary_priority_queue& other) {
+        const basic_binary_priority_queue* other_queue = &other;
 
-        if (current_size + other_queue->current_size > max_size) {
+        if (policy == capacity_policy::fixed && current_size + other_queue->current_size > max_size) {
             throw "Merge failed: Insufficient capacity in target queue.";
         }
+        int other_size = other_queue->current_size;
+        int first_appended = current_size;
+        ensure_capacity(current_size + other_size);
 
-        for (int i = 0; i < other_queue->current_size; ++i) {
-            if (other_queue->heap[i].value) {
-                add_value(other_queue->heap[i].value, other_queue->heap[i].priority);
-            }
+        append_copies(*other_queue, other_size);
+        restore_after_append(first_appended);
+        return *this;
+    }
+
+    // Слияние без копирования значений: если ни у одной из очередей нет фиксированной
+    // ёмкости, больший массив забирается целиком, элементы меньшего дописываются
+    // перемещением. Донор остаётся пустым, а фиксированный донор - со своим массивом
+    basic_binary_priority_queue& merge(basic_binary_priority_queue&& other) {
+        basic_binary_priority_queue* other_queue = &other;
+        if (other_queue == this) return *this;
+
+        if (policy == capacity_policy::fixed && current_size + other_queue->current_size > max_size) {
+            throw "Merge failed: Insufficient capacity in target queue.";
+        }
+
+        if (policy != capacity_policy::fixed && other_queue->policy != capacity_policy::fixed &&
+            other_queue->current_size > current_size) {
+            std::swap(heap, other_queue->heap);
+            std::swap(current_size, other_queue->current_size);
+            std::swap(max_size, other_queue->max_size);
         }
+
+        int other_size = other_queue->current_size;
+        int first_appended = current_size;
+        ensure_capacity(current_size + other_size);
+
+        for (int i = 0; i < other_size; ++i) {
+            heap[current_size++] = std::move(other_queue->heap[i]);
+        }
+        other_queue->current_size = 0;
+        other_queue->shrink_after_drain();
+
+        restore_after_append(first_appended);
         return *this;
     }
 
+    // Обход всех элементов в порядке массива кучи: visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        for (int i = 0; i < current_size; ++i) {
+            visit(heap[i].value, heap[i].priority);
+        }
+    }
+
     [[nodiscard]] bool is_empty() const {
         return current_size == 0;
     }
 
     [[nodiscard]] bool is_full() const {
-        return current_size >= max_size;
+        return policy == capacity_policy::fixed && current_size >= max_size;
+    }
+
+    [[nodiscard]] capacity_policy get_capacity_policy() const {
+        return policy;
+    }
+
+    // Заранее выделяет место под new_capacity элементов (ёмкость только растёт)
+    void reserve(int new_capacity) {
+        if (new_capacity < 0) throw "Invalid size: must be non-negative";
+        if (new_capacity > max_size) {
+            relocate(new_capacity);
+        }
+    }
+
+    // Ужимает буфер до текущего числа элементов
+    void shrink_to_fit() {
+        if (policy == capacity_policy::fixed) return;
+        if (current_size < max_size) {
+            relocate(current_size);
+        }
     }
 
     [[nodiscard]] int get_current_size() const {
         return current_size;
     }
 
+    [[nodiscard]] int size() const {
+        return current_size;
+    }
+
     [[nodiscard]] int get_max_size() const {
         return max_size;
     }
 
-    [[nodiscard]] binary_priority_queue meld(const binary_priority_queue& other) const {
-        binary_priority_queue result(current_size + other.current_size);
+    [[nodiscard]] basic_binary_priority_queue meld(const basic_binary_priority_queue& other) const {
+        basic_binary_priority_queue result(current_size + other.current_size, policy, compare);
 
-        for (int i = 0; i < current_size; ++i) {
-            if (heap[i].value) {
-                result.add_value(heap[i].value, heap[i].priority);
-            }
-        }
-
-        result.merge(other);
+        result.append_copies(*this, current_size);
+        result.append_copies(other, other.current_size);
+        result.build_heap();
         return result;
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const binary_priority_queue& queue) {
+    friend std::ostream& operator<<(std::ostream& os, const basic_binary_priority_queue& queue) {
         os << "Binary Priority Queue (size: " << queue.get_current_size()
            << "/" << queue.get_max_size() << "):\n";
 
@@ -258,14 +575,801 @@ public:
         }
 
         for (int i = 0; i < queue.get_current_size(); ++i) {
-            const char* value_str = queue.heap[i].value ? queue.heap[i].value : "null";
             os << "  [" << i << "] Priority: " << queue.heap[i].priority
-               << ", Value: " << value_str << "\n";
+               << ", Value: " << queue.heap[i].value << "\n";
         }
         return os;
     }
 };
 
+// Реализация интерфейса priority_queue: строки интернируются в общем пуле процесса,
+// копия элемента разделяет строку по счётчику ссылок
+class binary_priority_queue final : public basic_binary_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_binary_priority_queue<pooled_string>;
+
+    static pooled_string intern(const char* str) {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(node_pool::process_default().intern(str));
+    }
+
+    static pooled_string intern(const std::string& str) {
+        return intern(str.c_str());
+    }
+
+public:
+    binary_priority_queue() = default;
+
+    explicit binary_priority_queue(int initial_size, capacity_policy capacity_mode = capacity_policy::fixed)
+            : base(initial_size, capacity_mode) {
+    }
+
+    // Массовая загрузка из диапазона пар (строка, приоритет) за O(n)
+    template <typename InputIt>
+    binary_priority_queue(InputIt first, InputIt last, capacity_policy capacity_mode = capacity_policy::growable)
+            : base(0, capacity_policy::growable) {
+        reserve_for_range(first, last);
+        for (; first != last; ++first) {
+            append_unordered(intern(first->first), first->second);
+        }
+        finish_bulk_load(capacity_mode);
+    }
+
+    // Загрузка снимка: массив двоичной кучи восстанавливается в сохранённом порядке
+    // без перестройки, снимок другой очереди или помеченный, но не упорядоченный
+    // как куча, перестраивается за O(n)
+    explicit binary_priority_queue(const snapshot_view& snapshot, capacity_policy capacity_mode = capacity_policy::growable)
+            : base(0, capacity_policy::growable) {
+        reserve(snapshot.size());
+        for (const auto& record : snapshot) {
+            append_unordered(intern(record.first), record.second);
+        }
+        if (snapshot.is_heap_ordered() && holds_heap_order()) {
+            finish_ordered_load(capacity_mode);
+        }
+        else {
+            finish_bulk_load(capacity_mode);
+        }
+    }
+
+    void add_value(const char* str, int priority) override {
+        base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+
+    priority_queue& merge(const priority_queue& second) override {
+        auto other_queue = dynamic_cast<const binary_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        auto other_queue = dynamic_cast<binary_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] binary_priority_queue meld(const binary_priority_queue& other) const {
+        binary_priority_queue result;
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+template <>
+struct snapshot_in_heap_order<binary_priority_queue> : std::true_type {};
+
+// Пустая очередь забирает снимок целиком, иначе записи дописываются пакетной вставкой
+inline void load_snapshot(binary_priority_queue& queue, const snapshot_view& snapshot) {
+    if (queue.is_empty() && snapshot.size() > 0) {
+        binary_priority_queue loaded(snapshot, queue.get_capacity_policy());
+        loaded.reserve(queue.get_max_size());
+        queue = std::move(loaded);
+    }
+    else {
+        queue.add_range(snapshot.begin(), snapshot.end());
+    }
+}
+
+// Выбор лучшего ребёнка векторными инструкциями для int-приоритетов.
+// Записи {priority, slot} лежат парами слов, поэтому приоритеты группы сначала
+// собираются перестановкой в один регистр, затем ищется максимум (минимум)
+// и его позиция по маске сравнения. Набор инструкций определяется один раз при
+// запуске программы, но включается только явно через set_simd_level: на замерах
+// векторный спуск 4-арной кучи медленнее скалярного, а 8-арной не быстрее.
+// На других архитектурах остаётся скалярный цикл
+enum class simd_level { scalar, sse41, avx2 };
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HEAP_SIMD_X86 1
+#if defined(__GNUC__) || defined(__clang__)
+#define HEAP_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define HEAP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HEAP_TARGET_SSE41
+#define HEAP_TARGET_AVX2
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define HEAP_FORCE_INLINE __forceinline
+#else
+#define HEAP_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+inline simd_level detect_simd_level() {
+#if defined(HEAP_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    bool has_sse41 = (info[2] & (1 << 19)) != 0;
+    bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    bool has_avx = (info[2] & (1 << 28)) != 0;
+
+    bool has_avx2 = false;
+    if (max_leaf >= 7 && has_osxsave && has_avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        has_avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    if (has_avx2) return simd_level::avx2;
+    if (has_sse41) return simd_level::sse41;
+#elif defined(HEAP_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return simd_level::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return simd_level::sse41;
+#endif
+    return simd_level::scalar;
+}
+
+inline const simd_level supported_simd_level_value = detect_simd_level();
+inline simd_level active_simd_level_value = simd_level::scalar;
+
+[[nodiscard]] inline simd_level supported_simd_level() {
+    return supported_simd_level_value;
+}
+
+[[nodiscard]] inline simd_level active_simd_level() {
+    return active_simd_level_value;
+}
+
+// По умолчанию скалярный уровень; поднять его можно не выше поддерживаемого процессором
+inline void set_simd_level(simd_level level) {
+    active_simd_level_value = level < supported_simd_level_value ? level : supported_simd_level_value;
+}
+
+[[nodiscard]] inline const char* simd_level_name(simd_level level) {
+    switch (level) {
+    case simd_level::avx2: return "avx2";
+    case simd_level::sse41: return "sse4.1";
+    default: return "scalar";
+    }
+}
+
+#ifdef HEAP_SIMD_X86
+inline int lowest_set_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+template <bool Max>
+HEAP_TARGET_SSE41 inline __m128i select_extreme_sse41(__m128i a, __m128i b) {
+    return Max ? _mm_max_epi32(a, b) : _mm_min_epi32(a, b);
+}
+
+// 4 записи: приоритеты из слов 0 и 2 двух регистров собираются в один
+template <bool Max>
+HEAP_TARGET_SSE41 int best_of_4_sse41(const int* group) {
+    __m128 low = _mm_loadu_ps(reinterpret_cast<const float*>(group));
+    __m128 high = _mm_loadu_ps(reinterpret_cast<const float*>(group + 4));
+    __m128i priorities = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    __m128i extreme = select_extreme_sse41<Max>(priorities, _mm_shuffle_epi32(priorities, _MM_SHUFFLE(1, 0, 3, 2)));
+    extreme = select_extreme_sse41<Max>(extreme, _mm_shuffle_epi32(extreme, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(priorities, extreme)));
+    return lowest_set_bit(mask);
+}
+
+template <bool Max>
+HEAP_TARGET_SSE41 int best_of_8_sse41(const int* group) {
+    const float* words = reinterpret_cast<const float*>(group);
+    __m128i first = _mm_castps_si128(_mm_shuffle_ps(_mm_loadu_ps(words), _mm_loadu_ps(words + 4),
+                                                    _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i second = _mm_castps_si128(_mm_shuffle_ps(_mm_loadu_ps(words + 8), _mm_loadu_ps(words + 12),
+                                                     _MM_SHUFFLE(2, 0, 2, 0)));
+
+    __m128i extreme = select_extreme_sse41<Max>(first, second);
+    extreme = select_extreme_sse41<Max>(extreme, _mm_shuffle_epi32(extreme, _MM_SHUFFLE(1, 0, 3, 2)));
+    extreme = select_extreme_sse41<Max>(extreme, _mm_shuffle_epi32(extreme, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(first, extreme)))
+                  | (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(second, extreme))) << 4);
+    return lowest_set_bit(mask);
+}
+
+// 8 записей: перестановка внутри половин даёт порядок 0 1 4 5 | 2 3 6 7, перестановка
+// 64-битных слов возвращает порядок детей, чтобы при равенстве побеждал меньший номер
+template <bool Max>
+HEAP_TARGET_AVX2 int best_of_8_avx2(const int* group) {
+    __m256 low = _mm256_loadu_ps(reinterpret_cast<const float*>(group));
+    __m256 high = _mm256_loadu_ps(reinterpret_cast<const float*>(group + 8));
+    __m256i priorities = _mm256_permute4x64_epi64(
+        _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+
+    __m256i extreme = priorities;
+    __m256i swapped = _mm256_shuffle_epi32(extreme, _MM_SHUFFLE(2, 3, 0, 1));
+    extreme = Max ? _mm256_max_epi32(extreme, swapped) : _mm256_min_epi32(extreme, swapped);
+    swapped = _mm256_shuffle_epi32(extreme, _MM_SHUFFLE(1, 0, 3, 2));
+    extreme = Max ? _mm256_max_epi32(extreme, swapped) : _mm256_min_epi32(extreme, swapped);
+    swapped = _mm256_permute2x128_si256(extreme, extreme, 1);
+    extreme = Max ? _mm256_max_epi32(extreme, swapped) : _mm256_min_epi32(extreme, swapped);
+
+    unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(priorities, extreme)));
+    return lowest_set_bit(mask);
+}
+#endif
+
+// Выбор лучшего ребёнка в полной группе из Arity записей {int priority, int slot}.
+// Вызывается из цикла спуска, собранного под тот же набор инструкций, и встраивается в него
+#ifdef HEAP_SIMD_X86
+template <int Arity, bool Max>
+struct sse41_child_selector {
+    HEAP_TARGET_SSE41 static int best(const int* group) {
+        if constexpr (Arity == 8) {
+            return best_of_8_sse41<Max>(group);
+        }
+        else {
+            return best_of_4_sse41<Max>(group);
+        }
+    }
+};
+
+template <int Arity, bool Max>
+struct avx2_child_selector {
+    HEAP_TARGET_AVX2 static int best(const int* group) {
+        if constexpr (Arity == 8) {
+            return best_of_8_avx2<Max>(group);
+        }
+        else {
+            return best_of_4_sse41<Max>(group);
+        }
+    }
+};
+#endif
+
+// d-арная куча с компактным массивом ключей: в самой куче лежат только пары
+// (приоритет, номер слота), выровненные по кэш-линии, а значения хранятся в
+// параллельном массиве слотов и при просеивании не перемещаются - значение
+// читается один раз при извлечении. Корень сдвинут на Arity - 1 позиций, поэтому
+// дети любого узла начинаются с индекса, кратного Arity: при
+// Arity * sizeof(entry) <= 64 вся группа детей лежит в одной кэш-линии
+// (int-приоритеты: d = 8, 8-байтовые: d = 4)
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>, int Arity = 8>
+class basic_dary_priority_queue {
+    static_assert(Arity >= 2, "Arity must be at least 2");
+    static_assert(std::is_trivially_copyable_v<Priority>, "Priority must be trivially copyable");
+
+    struct entry {
+        Priority priority;
+        int slot;
+    };
+
+    static constexpr int OFFSET = Arity - 1;
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Векторный выбор ребёнка есть только для int-приоритетов со стандартным порядком
+    static constexpr bool SIMD_SELECTABLE =
+        std::is_same_v<Priority, int> && sizeof(entry) == 2 * sizeof(int) && (Arity == 4 || Arity == 8) &&
+        (std::is_same_v<Compare, std::less<int>> || std::is_same_v<Compare, std::greater<int>>);
+
+    entry* entries;   // entries[i + OFFSET] - i-й элемент кучи
+    T* slots;         // значения, адресуемые entry::slot
+    int* free_slots;  // стек освобождённых слотов
+    int free_count;
+    int slot_count;   // слоты [0, slot_count) хоть раз выдавались
+    int current_size;
+    int capacity;
+    Compare compare;
+
+    static entry* allocate_entries(int count) {
+        if (count == 0) return nullptr;
+        return static_cast<entry*>(::operator new(sizeof(entry) * (count + OFFSET),
+                                                  std::align_val_t(CACHE_LINE)));
+    }
+
+    static void free_entries(entry* ptr) {
+        if (ptr) ::operator delete(ptr, std::align_val_t(CACHE_LINE));
+    }
+
+    static T* allocate_slots(int count) {
+        if (count == 0) return nullptr;
+        return static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(alignof(T))));
+    }
+
+    static void free_slot_storage(T* ptr) {
+        if (ptr) ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+
+    entry& at(int index) {
+        return entries[index + OFFSET];
+    }
+
+    const entry& at(int index) const {
+        return entries[index + OFFSET];
+    }
+
+    int acquire_slot() {
+        return free_count > 0 ? free_slots[--free_count] : slot_count++;
+    }
+
+    void release_slot(int slot) {
+        slots[slot].~T();
+        free_slots[free_count++] = slot;
+    }
+
+    void destroy_values() {
+        for (int i = 0; i < current_size; ++i) {
+            slots[at(i).slot].~T();
+        }
+    }
+
+    // Переносит кучу в буферы новой ёмкости: записи и стек слотов копируются блоком,
+    // живые значения перемещаются в слоты с теми же номерами
+    void relocate(int new_capacity) {
+        entry* new_entries = allocate_entries(new_capacity);
+        T* new_slots = allocate_slots(new_capacity);
+        int* new_free_slots = new_capacity > 0 ? new int[new_capacity] : nullptr;
+
+        if (current_size > 0) {
+            std::memcpy(new_entries + OFFSET, entries + OFFSET, sizeof(entry) * current_size);
+        }
+        if (free_count > 0) {
+            std::memcpy(new_free_slots, free_slots, sizeof(int) * free_count);
+        }
+        for (int i = 0; i < current_size; ++i) {
+            int slot = at(i).slot;
+            new (new_slots + slot) T(std::move(slots[slot]));
+            slots[slot].~T();
+        }
+
+        free_entries(entries);
+        free_slot_storage(slots);
+        delete[] free_slots;
+        entries = new_entries;
+        slots = new_slots;
+        free_slots = new_free_slots;
+        capacity = new_capacity;
+    }
+
+    void ensure_capacity(int required) {
+        if (required <= capacity) return;
+
+        int new_capacity = capacity > 0 ? capacity : Arity;
+        while (new_capacity < required) {
+            new_capacity *= 2;
+        }
+        relocate(new_capacity);
+    }
+
+    // Лучший из детей, начиная с first_child. Лучший приоритет держится в регистре,
+    // а не перечитывается по индексу, чтобы сравнения не ждали друг друга; полная
+    // группа обходится циклом с постоянным числом шагов, который разворачивается
+    [[nodiscard]] int best_child(int first_child) const {
+        const entry* group = &at(first_child);
+        int count = first_child + Arity <= current_size ? Arity : current_size - first_child;
+
+        int best = 0;
+        Priority best_priority = group[0].priority;
+        if (count == Arity) {
+            for (int i = 1; i < Arity; ++i) {
+                bool better = compare(best_priority, group[i].priority);
+                best = better ? i : best;
+                best_priority = better ? group[i].priority : best_priority;
+            }
+        }
+        else {
+            for (int i = 1; i < count; ++i) {
+                bool better = compare(best_priority, group[i].priority);
+                best = better ? i : best;
+                best_priority = better ? group[i].priority : best_priority;
+            }
+        }
+        return first_child + best;
+    }
+
+    void sift_up(int index) {
+        entry moving = at(index);
+
+        while (index > 0) {
+            int parent = (index - 1) / Arity;
+            if (!compare(at(parent).priority, moving.priority))
+                break;
+            at(index) = at(parent);
+            index = parent;
+        }
+
+        at(index) = moving;
+    }
+
+    struct scalar_child_selector {
+        static int best(const basic_dary_priority_queue& queue, int first_child) {
+            return queue.best_child(first_child);
+        }
+    };
+
+#ifdef HEAP_SIMD_X86
+    template <typename Vector>
+    struct vector_child_selector {
+        HEAP_FORCE_INLINE static int best(const basic_dary_priority_queue& queue, int first_child) {
+            if (first_child + Arity > queue.current_size) return queue.best_child(first_child);
+            return first_child + Vector::best(reinterpret_cast<const int*>(&queue.at(first_child)));
+        }
+    };
+
+    using sse41_selector = vector_child_selector<sse41_child_selector<Arity, std::is_same_v<Compare, std::less<int>>>>;
+    using avx2_selector = vector_child_selector<avx2_child_selector<Arity, std::is_same_v<Compare, std::less<int>>>>;
+
+    HEAP_TARGET_SSE41 int descend_sse41(int index) {
+        return descend_to_leaf<sse41_selector>(index);
+    }
+
+    HEAP_TARGET_AVX2 int descend_avx2(int index) {
+        return descend_to_leaf<avx2_selector>(index);
+    }
+#endif
+
+    // Дырка спускается до листа по лучшим детям без сравнения с перемещаемым
+    // элементом (он почти всегда возвращается вниз); возвращает позицию листа
+    template <typename Selector>
+    HEAP_FORCE_INLINE int descend_to_leaf(int index) {
+        while (true) {
+            int first_child = index * Arity + 1;
+            if (first_child >= current_size)
+                break;
+
+            int best = Selector::best(*this, first_child);
+            at(index) = at(best);
+            index = best;
+        }
+        return index;
+    }
+
+    // Просеивание снизу вверх: сначала спуск дырки до листа, затем подъём элемента.
+    // Векторный вариант спуска выбирается один раз на извлечение, а не на каждом уровне
+    void sift_down_to_leaf(int index) {
+        entry moving = at(index);
+        int leaf = -1;
+
+#ifdef HEAP_SIMD_X86
+        if constexpr (SIMD_SELECTABLE) {
+            simd_level level = active_simd_level();
+            if (level == simd_level::avx2) leaf = descend_avx2(index);
+            else if (level == simd_level::sse41) leaf = descend_sse41(index);
+        }
+#endif
+        if (leaf < 0) leaf = descend_to_leaf<scalar_child_selector>(index);
+
+        at(leaf) = moving;
+        sift_up(leaf);
+    }
+
+    void sift_down(int index) {
+        entry moving = at(index);
+
+        while (true) {
+            int first_child = index * Arity + 1;
+            if (first_child >= current_size)
+                break;
+
+            int best = best_child(first_child);
+            if (!compare(moving.priority, at(best).priority))
+                break;
+
+            at(index) = at(best);
+            index = best;
+        }
+
+        at(index) = moving;
+    }
+
+    void build_heap() {
+        for (int i = (current_size - 2) / Arity; i >= 0; --i) {
+            sift_down(i);
+        }
+    }
+
+    // Как и у двоичной кучи: поштучный подъём ~m*log_d(n) против перестройки ~n
+    void restore_after_append(int first_appended) {
+        int appended = current_size - first_appended;
+        if (appended <= 0) return;
+
+        int levels = 0;
+        for (int size = current_size; size > 1; size /= Arity) {
+            ++levels;
+        }
+
+        if (static_cast<long long>(appended) * levels > 2LL * current_size) {
+            build_heap();
+        }
+        else {
+            for (int i = first_appended; i < current_size; ++i) {
+                sift_up(i);
+            }
+        }
+    }
+
+    template <typename Value>
+    void append_unordered(Value&& value, const Priority& priority) {
+        int slot = acquire_slot();
+        new (slots + slot) T(std::forward<Value>(value));
+        at(current_size) = entry{ priority, slot };
+        current_size++;
+    }
+
+    // Обмен массивами без порядка: merge забирает больший массив, оставляя свой compare
+    void swap_storage(basic_dary_priority_queue& other) noexcept {
+        std::swap(entries, other.entries);
+        std::swap(slots, other.slots);
+        std::swap(free_slots, other.free_slots);
+        std::swap(free_count, other.free_count);
+        std::swap(slot_count, other.slot_count);
+        std::swap(current_size, other.current_size);
+        std::swap(capacity, other.capacity);
+    }
+
+    void swap_queues(basic_dary_priority_queue& other) noexcept {
+        swap_storage(other);
+        std::swap(compare, other.compare);
+    }
+
+public:
+    explicit basic_dary_priority_queue(const Compare& order = Compare())
+            : entries(nullptr), slots(nullptr), free_slots(nullptr), free_count(0), slot_count(0),
+              current_size(0), capacity(0), compare(order) {
+    }
+
+    // Копия раскладывает значения по слотам подряд, без дыр
+    basic_dary_priority_queue(const basic_dary_priority_queue& other)
+            : basic_dary_priority_queue(other.compare) {
+        reserve(other.current_size);
+        for (int i = 0; i < other.current_size; ++i) {
+            append_unordered(other.slots[other.at(i).slot], other.at(i).priority);
+        }
+    }
+
+    basic_dary_priority_queue& operator=(const basic_dary_priority_queue& other) {
+        if (this != &other) {
+            basic_dary_priority_queue temp(other);
+            swap_queues(temp);
+        }
+        return *this;
+    }
+
+    basic_dary_priority_queue(basic_dary_priority_queue&& other) noexcept
+            : basic_dary_priority_queue(other.compare) {
+        swap_queues(other);
+    }
+
+    basic_dary_priority_queue& operator=(basic_dary_priority_queue&& other) noexcept {
+        if (this != &other) {
+            basic_dary_priority_queue temp(std::move(other));
+            swap_queues(temp);
+        }
+        return *this;
+    }
+
+    ~basic_dary_priority_queue() {
+        destroy_values();
+        free_entries(entries);
+        free_slot_storage(slots);
+        delete[] free_slots;
+    }
+
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        ensure_capacity(current_size + 1);
+        append_unordered(std::forward<Value>(value), priority);
+        sift_up(current_size - 1);
+    }
+
+    [[nodiscard]] const T& search_value() const {
+        if (is_empty()) throw "Queue is empty";
+        return slots[at(0).slot];
+    }
+
+    [[nodiscard]] const Priority& search_priority() const {
+        if (is_empty()) throw "Queue is empty";
+        return at(0).priority;
+    }
+
+    void delete_value() {
+        if (is_empty()) throw "Queue is empty";
+
+        release_slot(at(0).slot);
+        current_size--;
+
+        if (current_size > 0) {
+            at(0) = at(current_size);
+            sift_down_to_leaf(0);
+        }
+        if (current_size == 0) {
+            free_count = 0;
+            slot_count = 0;
+        }
+    }
+
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (is_empty()) throw "Queue is empty";
+
+        T value = std::move(slots[at(0).slot]);
+        delete_value();
+        return value;
+    }
+
+    basic_dary_priority_queue& merge(const basic_dary_priority_queue& other) {
+        if (&other == this) {
+            basic_dary_priority_queue copy(other);
+            return merge(std::move(copy));
+        }
+
+        int first_appended = current_size;
+        ensure_capacity(current_size + other.current_size);
+
+        for (int i = 0; i < other.current_size; ++i) {
+            append_unordered(other.slots[other.at(i).slot], other.at(i).priority);
+        }
+        restore_after_append(first_appended);
+        return *this;
+    }
+
+    // Больший массив забирается целиком, значения меньшего дописываются перемещением
+    basic_dary_priority_queue& merge(basic_dary_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        if (other.current_size > current_size) {
+            swap_storage(other);
+        }
+
+        int first_appended = current_size;
+        ensure_capacity(current_size + other.current_size);
+
+        for (int i = 0; i < other.current_size; ++i) {
+            append_unordered(std::move(other.slots[other.at(i).slot]), other.at(i).priority);
+        }
+        other.destroy_values();
+        other.current_size = 0;
+        other.free_count = 0;
+        other.slot_count = 0;
+
+        restore_after_append(first_appended);
+        return *this;
+    }
+
+    // Заранее выделяет место под new_capacity элементов (ёмкость только растёт)
+    void reserve(int new_capacity) {
+        if (new_capacity < 0) throw "Invalid size: must be non-negative";
+        if (new_capacity > capacity) {
+            relocate(new_capacity);
+        }
+    }
+
+    [[nodiscard]] bool is_empty() const {
+        return current_size == 0;
+    }
+
+    [[nodiscard]] int get_size() const {
+        return current_size;
+    }
+
+    [[nodiscard]] int size() const {
+        return current_size;
+    }
+
+    [[nodiscard]] int get_capacity() const {
+        return capacity;
+    }
+
+    [[nodiscard]] static constexpr int arity() {
+        return Arity;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+// Счётчик выделений памяти для замера аллокаций на операцию в main
+#include "allocation_counter.h"
+
+// Сравнение с состоянием: направление очереди выбирается при её создании
+struct direction_order {
+    bool max_first;
+
+    bool operator()(int first, int second) const {
+        return max_first ? first < second : first > second;
+    }
+};
+
+// Присваивание переносит порядок вместе с элементами: после него вершина -
+// наименьший элемент, как у очереди-источника
+template <typename Queue>
+int top_after_assigning_min_queue(bool by_move) {
+    Queue max_queue(direction_order{ true });
+    max_queue.add_value(0, 0);
+    Queue min_queue(direction_order{ false });
+    min_queue.add_value(1, 1);
+    min_queue.add_value(5, 5);
+
+    if (by_move) {
+        max_queue = std::move(min_queue);
+    }
+    else {
+        max_queue = min_queue;
+    }
+    max_queue.add_value(7, 7);
+    return max_queue.search_priority();
+}
+
 int main() {
     try {
         std::cout << "Creating q1...\n";
@@ -312,6 +1416,13 @@ int main() {
         std::cout << "Queue 5 size after meld: " << q5.get_current_size() << "\n";
         std::cout << "Queue 5:\n" << q5 << "\n";
 
+        std::cout << "Testing bulk load...\n";
+        std::vector<std::pair<std::string, int>> jobs = {
+            {"load-a", 7}, {"load-b", 42}, {"load-c", 3}, {"load-d", 19}, {"load-e", 25}
+        };
+        binary_priority_queue q_bulk(jobs.begin(), jobs.end());
+        std::cout << "Bulk-loaded queue:\n" << q_bulk << "\n";
+
         std::cout << "Testing merge...\n";
         binary_priority_queue q6(10);
         q6.add_value("sixth", 30);
@@ -319,16 +1430,91 @@ int main() {
         std::cout << "Queue 6 size after merge: " << q6.get_current_size() << "\n";
         std::cout << "Queue 6:\n" << q6 << "\n";
 
+        // Фиксированный донор после слияния перемещением остаётся пустой очередью своей ёмкости
+        binary_priority_queue fixed_donor(4);
+        fixed_donor.add_value("donor-a", 12);
+        fixed_donor.add_value("donor-b", 8);
+        binary_priority_queue move_target;
+        move_target.merge(std::move(fixed_donor));
+        fixed_donor.add_value("donor-c", 1);
+        std::cout << "Move-merged target size: " << move_target.get_current_size()
+                  << ", fixed donor size/capacity: " << fixed_donor.get_current_size()
+                  << "/" << fixed_donor.get_max_size() << "\n\n";
+
         std::cout << "Testing delete_value...\n";
         q1.delete_value();
         std::cout << "Queue 1 size after delete: " << q1.get_current_size() << "\n";
         std::cout << "Queue 1:\n" << q1 << "\n";
 
+        std::cout << "Testing growable queue...\n";
+        binary_priority_queue q7(0, binary_priority_queue::capacity_policy::elastic);
+        for (int i = 0; i < 100; ++i) {
+            q7.add_value("burst", i);
+        }
+        std::cout << "Queue 7 size/capacity after burst: " << q7.get_current_size()
+                  << "/" << q7.get_max_size() << "\n";
+        while (!q7.is_empty()) {
+            q7.delete_value();
+        }
+        std::cout << "Queue 7 capacity after drain: " << q7.get_max_size() << "\n";
+
+        binary_priority_queue q8;
+        q8.reserve(64);
+        q8.add_value("hot", 1);
+        std::cout << "Queue 8 reserved capacity: " << q8.get_max_size() << "\n";
+        q8.shrink_to_fit();
+        std::cout << "Queue 8 capacity after shrink_to_fit: " << q8.get_max_size() << "\n\n";
+
+        std::cout << "Testing assignment with a stateful comparator...\n";
+        using binary_directed = basic_binary_priority_queue<int, int, direction_order>;
+        using dary_directed = basic_dary_priority_queue<int, int, direction_order, 4>;
+        std::cout << "Binary top after copy/move assignment: "
+                  << top_after_assigning_min_queue<binary_directed>(false) << "/"
+                  << top_after_assigning_min_queue<binary_directed>(true) << "\n";
+        std::cout << "4-ary top after copy/move assignment: "
+                  << top_after_assigning_min_queue<dary_directed>(false) << "/"
+                  << top_after_assigning_min_queue<dary_directed>(true) << "\n\n";
+
         std::cout << "Testing through interface...\n";
         priority_queue* interface_ptr = &q2;
         const char* interface_max = interface_ptr->search_value(); 
         std::cout << "Max via interface: " << interface_max << "\n";
 
+        std::vector<std::pair<std::string, int>> batch;
+        interface_ptr->top_k(2, batch);
+        std::cout << "Top 2 via interface:";
+        for (const auto& item : batch) {
+            std::cout << " " << item.first << "(" << item.second << ")";
+        }
+        batch.clear();
+        int popped = interface_ptr->pop_batch(10, batch);
+        std::cout << "\npop_batch(10) took " << popped << ", queue size now " << interface_ptr->size() << "\n";
+
+        std::string polled;
+        int polled_priority = 0;
+        std::cout << "try_pop on empty queue: " << (interface_ptr->try_pop(polled, polled_priority) ? "true" : "false") << "\n\n";
+
+        std::cout << "Allocations per operation...\n";
+        const int ops = 100000;
+        std::mt19937 generator(42);
+        binary_priority_queue q9;
+        q9.reserve(ops);
+
+        long long before_push = allocation_count;
+        for (int i = 0; i < ops; ++i) {
+            q9.add_value("payload", static_cast<int>(generator()));
+        }
+        long long push_allocations = allocation_count - before_push;
+
+        long long before_pop = allocation_count;
+        while (!q9.is_empty()) {
+            q9.delete_value();
+        }
+        long long pop_allocations = allocation_count - before_pop;
+
+        std::cout << "Allocations per push: " << static_cast<double>(push_allocations) / ops << "\n";
+        std::cout << "Allocations per pop: " << static_cast<double>(pop_allocations) / ops << "\n";
+        std::cout << "Interned strings left in pool: " << node_pool::process_default().interned_strings() << "\n";
     }
     catch (const char* msg) {
         std::cerr << "Error: " << msg << "\n";
@@ -337,4 +1523,4 @@ int main() {
 
     return 0;
 }
-
+#endif
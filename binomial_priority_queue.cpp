@@ -1,47 +1,46 @@
 #include <iostream>
+#include <algorithm>
 #include <cstring>
-#include "../../source/repos/second_sem_labs/priority_queue.h"
-
-class binomial_priority_queue final : public priority_queue {
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "5z.h"
+#include "node_pool.h"
+
+// Биномиальная куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Значения перемещаются в узлы и из них
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_binomial_priority_queue {
 private:
+    // Узлы выделяются из node_pool
     struct BinomialNode {
-        char* value;
-        int priority;
+        T value;
+        Priority priority;
         int degree;
         BinomialNode* child;
         BinomialNode* sibling;
         BinomialNode* parent;
 
-        BinomialNode(const char* str, int p) : priority(p), degree(0),
-                                              child(nullptr), sibling(nullptr), parent(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                std::strcpy(value, str);
-            } else {
-                value = nullptr;
-            }
-        }
+        template <typename Value>
+        BinomialNode(Value&& v, const Priority& p) : value(std::forward<Value>(v)), priority(p), degree(0),
+                                                    child(nullptr), sibling(nullptr), parent(nullptr) {}
 
-        BinomialNode(const BinomialNode& other) : priority(other.priority), degree(other.degree),
-                                                 child(nullptr), sibling(nullptr), parent(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
-            } else {
-                value = nullptr;
-            }
-        }
-
-        ~BinomialNode() {
-            delete[] value;
-        }
+        BinomialNode(const BinomialNode&) = delete;
+        BinomialNode& operator=(const BinomialNode&) = delete;
     };
 
+    // Корневой список упорядочен по возрастанию степени, max_root - корень с вершиной очереди
     BinomialNode* head;
+    BinomialNode* max_root;
+    int node_count;
+    node_pool* pool;
+    Compare compare;
 
 private:
     BinomialNode* link_trees(BinomialNode* tree1, BinomialNode* tree2) {
-        if (tree1->priority < tree2->priority) {
+        if (compare(tree1->priority, tree2->priority)) {
             BinomialNode* temp = tree1;
             tree1 = tree2;
             tree2 = temp;
@@ -126,32 +125,61 @@ private:
         return prev;
     }
 
-    BinomialNode* copy_tree(BinomialNode* node) const {
-        if (!node) return nullptr;
-        BinomialNode* new_node = new BinomialNode(node->value, node->priority);
-        new_node->degree = node->degree;
-        new_node->child = copy_tree(node->child);
-        if (new_node->child) new_node->child->parent = new_node;
-        return new_node;
-    }
-
-    BinomialNode* copy_list(BinomialNode* list) const {
-        if (!list) return nullptr;
-        BinomialNode* new_list = copy_tree(list);
-        new_list->sibling = copy_list(list->sibling);
-        return new_list;
+    // Копирует цепочку братьев в *out; каждый узел подвешивается сразу, чтобы при исключении
+    // частичная копия оставалась достижимой. Узлы с детьми откладываются в pending
+    void copy_siblings(const BinomialNode* source, BinomialNode* parent, BinomialNode** out,
+                       std::vector<std::pair<const BinomialNode*, BinomialNode*>>& pending) const {
+        for (; source; source = source->sibling) {
+            BinomialNode* node = pool->template create<BinomialNode>(source->value, source->priority);
+            node->degree = source->degree;
+            node->parent = parent;
+            *out = node;
+            out = &node->sibling;
+
+            if (source->child) {
+                pending.push_back({ source, node });
+            }
+        }
     }
 
-    void delete_tree(BinomialNode* node) {
-        if (!node) return;
-        delete_tree(node->child);
-        delete_tree(node->sibling);
-        delete node;
+    // Копирование без рекурсии: поддеревья отложенных узлов копируются тем же циклом
+    BinomialNode* copy_list(const BinomialNode* list) const {
+        std::vector<std::pair<const BinomialNode*, BinomialNode*>> pending;
+        BinomialNode* result = nullptr;
+
+        try {
+            copy_siblings(list, nullptr, &result, pending);
+            while (!pending.empty()) {
+                const BinomialNode* source = pending.back().first;
+                BinomialNode* target = pending.back().second;
+                pending.pop_back();
+                copy_siblings(source->child, target, &target->child, pending);
+            }
+        }
+        catch (...) {
+            delete_tree(result);
+            throw;
+        }
+        return result;
     }
 
-    [[nodiscard]] int count_nodes(BinomialNode* node) const {
-        if (!node) return 0;
-        return 1 + count_nodes(node->child) + count_nodes(node->sibling);
+    // Удаление поворотами, как в левосторонней куче: child играет роль левого ребёнка,
+    // sibling - правого. Память не нужна, блоки возвращаются в пул одной цепочкой
+    void delete_tree(BinomialNode* node) const {
+        node_pool::teardown<BinomialNode> batch(*pool);
+        while (node) {
+            if (node->child) {
+                BinomialNode* child = node->child;
+                node->child = child->sibling;
+                child->sibling = node;
+                node = child;
+            }
+            else {
+                BinomialNode* sibling = node->sibling;
+                batch.destroy(node);
+                node = sibling;
+            }
+        }
     }
 
     [[nodiscard]] BinomialNode* find_max_node() const {
@@ -161,7 +189,7 @@ private:
         BinomialNode* current = head->sibling;
 
         while (current) {
-            if (current->priority > max_node->priority) {
+            if (compare(max_node->priority, current->priority)) {
                 max_node = current;
             }
             current = current->sibling;
@@ -170,70 +198,108 @@ private:
         return max_node;
     }
 
+    // Корневой список пересобран целиком: вершина ищется заново за O(log n)
+    void set_head(BinomialNode* list) {
+        head = list;
+        max_root = find_max_node();
+    }
+
     void print_tree(std::ostream& os, BinomialNode* node, int depth = 0) const {
         if (!node) return;
 
         for (int i = 0; i < depth; ++i) os << "  ";
         os << "B" << node->degree << " [Prio: " << node->priority
-           << ", Val: " << (node->value ? node->value : "null") << "]\n";
+           << ", Val: " << node->value << "]\n";
 
         print_tree(os, node->child, depth + 1);
         print_tree(os, node->sibling, depth);
     }
 
 public:
-    binomial_priority_queue() : head(nullptr) {}
+    basic_binomial_priority_queue() : basic_binomial_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_binomial_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : head(nullptr), max_root(nullptr), node_count(0), pool(&shared_pool), compare(order) {}
 
-    binomial_priority_queue(const binomial_priority_queue& other) : head(nullptr) {
+    basic_binomial_priority_queue(const basic_binomial_priority_queue& other)
+        : head(nullptr), max_root(nullptr), node_count(other.node_count), pool(other.pool), compare(other.compare) {
         if (other.head) {
-            head = copy_list(other.head);
+            set_head(copy_list(other.head));
         }
     }
 
-    binomial_priority_queue& operator=(const binomial_priority_queue& other) {
+    basic_binomial_priority_queue& operator=(const basic_binomial_priority_queue& other) {
         if (this != &other) {
+            BinomialNode* copy = copy_list(other.head);
             delete_tree(head);
-            head = other.head ? copy_list(other.head) : nullptr;
+            set_head(copy);
+            node_count = other.node_count;
+            compare = other.compare;
         }
         return *this;
     }
 
-    binomial_priority_queue(binomial_priority_queue&& other) noexcept : head(other.head) {
+    basic_binomial_priority_queue(basic_binomial_priority_queue&& other) noexcept
+        : head(other.head), max_root(other.max_root), node_count(other.node_count), pool(other.pool),
+          compare(other.compare) {
         other.head = nullptr;
+        other.max_root = nullptr;
+        other.node_count = 0;
     }
 
-    binomial_priority_queue& operator=(binomial_priority_queue&& other) noexcept {
+    basic_binomial_priority_queue& operator=(basic_binomial_priority_queue&& other) noexcept {
         if (this != &other) {
             delete_tree(head);
             head = other.head;
+            max_root = other.max_root;
+            node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
             other.head = nullptr;
+            other.max_root = nullptr;
+            other.node_count = 0;
         }
         return *this;
     }
 
-    ~binomial_priority_queue() {
+    ~basic_binomial_priority_queue() {
         delete_tree(head);
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
+    // Вставка как прибавление единицы к двоичному счётчику: новый узел степени 0 сливается
+    // с корнями равной степени в начале списка, пока есть перенос. Амортизированно O(1)
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        BinomialNode* carry = pool->template create<BinomialNode>(std::forward<Value>(value), priority);
+        while (head && head->degree == carry->degree) {
+            BinomialNode* next = head->sibling;
+            carry = link_trees(carry, head);
+            head = next;
+        }
+        carry->sibling = head;
+        head = carry;
+        ++node_count;
 
-        binomial_priority_queue temp;
-        temp.head = new BinomialNode(str, priority);
-        merge(temp);
+        // Поглощённая вершина стала потомком carry, и carry не меньше неё
+        if (!max_root || max_root->parent || compare(max_root->priority, carry->priority)) {
+            max_root = carry;
+        }
     }
 
-    [[nodiscard]] const char* search_value() const override {
-        BinomialNode* max_node = find_max_node();
-        if (!max_node) throw "Queue is empty";
-        return max_node->value;
+    [[nodiscard]] const T& search_value() const {
+        if (!max_root) throw "Queue is empty";
+        return max_root->value;
     }
 
-    void delete_value() override {
-        BinomialNode* max_node = find_max_node();
-        if (!max_node) throw "Queue is empty";
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!max_root) throw "Queue is empty";
+        return max_root->priority;
+    }
 
+private:
+    // Снимает корень max_node с корневого списка и возвращает его детей в очередь
+    void remove_root(BinomialNode* max_node) {
         if (max_node == head) {
             head = head->sibling;
         } else {
@@ -244,26 +310,148 @@ public:
             prev->sibling = max_node->sibling;
         }
 
-        BinomialNode* child_list = reverse_list(max_node->child);
-        binomial_priority_queue temp;
-        temp.head = child_list;
-        merge(temp);
-
+        // Дети корня уже идут по убыванию степени: развёрнутые, они сливаются с корневым списком
+        --node_count;
+        set_head(consolidate(merge_lists(head, reverse_list(max_node->child))));
         max_node->child = nullptr;
-        delete max_node;
+        pool->destroy(max_node);
     }
 
-    priority_queue& merge(const priority_queue& second) override {
-        const binomial_priority_queue* other_queue =
-            dynamic_cast<const binomial_priority_queue*>(&second);
+public:
+    void delete_value() {
+        if (!max_root) throw "Queue is empty";
+        remove_root(max_root);
+    }
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!max_root) throw "Queue is empty";
+
+        T value = std::move(max_root->value);
+        remove_root(max_root);
+        return value;
+    }
+
+protected:
+    // Пакетная вставка за O(n): одиночные узлы собираются в список и один раз
+    // сливаются с корневым списком через таблицу степеней, как двоичный счётчик.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        BinomialNode* singles = nullptr;
+        int added = 0;
+        try {
+            for (; first != last; ++first) {
+                BinomialNode* node = pool->template create<BinomialNode>(make_value(first->first), first->second);
+                node->sibling = singles;
+                singles = node;
+                ++added;
+            }
+        }
+        catch (...) {
+            set_head(consolidate(merge_lists(head, singles)));
+            node_count += added;
+            throw;
         }
+        set_head(consolidate(merge_lists(head, singles)));
+        node_count += added;
+    }
 
-        BinomialNode* other_head = copy_list(other_queue->head);
-        head = merge_lists(head, other_head);
-        head = consolidate(head);
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    // Обход всех элементов: корневой список и списки детей с явным стеком, visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const BinomialNode*> pending;
+        if (head) pending.push_back(head);
+
+        while (!pending.empty()) {
+            const BinomialNode* node = pending.back();
+            pending.pop_back();
+            visit(node->value, node->priority);
+
+            if (node->sibling) pending.push_back(node->sibling);
+            if (node->child) pending.push_back(node->child);
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && head; ++taken) {
+            consume(std::move(max_root->value), max_root->priority);
+            remove_root(max_root);
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Фронт кандидатов начинается с корневого списка; выданный узел добавляет в него свой
+    // список детей: O(count * log n) сравнений на фронте вместо копии кучи
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const BinomialNode* first, const BinomialNode* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const BinomialNode*> frontier;
+        if (count > 0) {
+            for (const BinomialNode* root = head; root; root = root->sibling) {
+                frontier.push_back(root);
+            }
+            std::make_heap(frontier.begin(), frontier.end(), lower);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const BinomialNode* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            ++visited;
+
+            for (const BinomialNode* child = node->child; child; child = child->sibling) {
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), lower);
+            }
+        }
+        return visited;
+    }
+
+    basic_binomial_priority_queue& merge(const basic_binomial_priority_queue& other) {
+        BinomialNode* other_head = copy_list(other.head);
+        set_head(consolidate(merge_lists(head, other_head)));
+        node_count += other.node_count;
+
+        return *this;
+    }
+
+    // Слияние без копирования: корневой список донора вливается в свой, донор остаётся пустым
+    basic_binomial_priority_queue& merge(basic_binomial_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_binomial_priority_queue&>(other));
+            other = basic_binomial_priority_queue(*other.pool, other.compare);
+            return *this;
+        }
+
+        set_head(consolidate(merge_lists(head, other.head)));
+        node_count += other.node_count;
+        other.head = nullptr;
+        other.max_root = nullptr;
+        other.node_count = 0;
 
         return *this;
     }
@@ -273,19 +461,29 @@ public:
     }
 
     [[nodiscard]] int get_size() const {
-        return count_nodes(head);
+        return node_count;
     }
 
-    [[nodiscard]] binomial_priority_queue meld(const binomial_priority_queue& other) const {
-        binomial_priority_queue result;
-        result.head = copy_list(head);
-        binomial_priority_queue temp;
-        temp.head = copy_list(other.head);
-        result.merge(temp);
+    [[nodiscard]] int size() const {
+        return node_count;
+    }
+
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
+    }
+
+    [[nodiscard]] basic_binomial_priority_queue meld(const basic_binomial_priority_queue& other) const {
+        basic_binomial_priority_queue result(*pool, compare);
+        result.set_head(copy_list(head));
+        result.node_count = node_count;
+        basic_binomial_priority_queue temp(*pool, compare);
+        temp.set_head(copy_list(other.head));
+        temp.node_count = other.node_count;
+        result.merge(std::move(temp));
         return result;
     }
 
-    friend void print_binomial_queue(const binomial_priority_queue& queue, const char* name) {
+    friend void print_binomial_queue(const basic_binomial_priority_queue& queue, const char* name) {
         std::cout << name << " (size: " << queue.get_size() << "):\n";
 
         if (queue.head) {
@@ -297,6 +495,102 @@ public:
     }
 };
 
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class binomial_priority_queue final : public basic_binomial_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_binomial_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        const binomial_priority_queue* other_queue =
+            dynamic_cast<const binomial_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        binomial_priority_queue* other_queue = dynamic_cast<binomial_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] binomial_priority_queue meld(const binomial_priority_queue& other) const {
+        binomial_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
 int main() {
     try {
         binomial_priority_queue queue1, queue2;
@@ -316,9 +610,42 @@ int main() {
         queue1.delete_value();
         print_binomial_queue(queue1, "After delete");
 
+        // Записи хранятся в узлах как есть, порядок - по возрастанию времени
+        struct task_record {
+            int id;
+            int retries;
+        };
+
+        basic_binomial_priority_queue<task_record, double, std::greater<double>> timers;
+        timers.add_value(task_record{ 1, 0 }, 2.5);
+        timers.add_value(task_record{ 2, 3 }, 0.75);
+        timers.add_value(task_record{ 3, 1 }, 1.25);
+
+        std::cout << "Timers by deadline:";
+        while (!timers.is_empty()) {
+            double deadline = timers.search_priority();
+            task_record task = timers.extract_value();
+            std::cout << " #" << task.id << "@" << deadline;
+        }
+        std::cout << std::endl;
+
+        // Копирование и удаление большой очереди идут без рекурсии
+        {
+            const int bulk_count = 10000000;
+            binomial_priority_queue bulk_queue;
+            for (int i = 0; i < bulk_count; ++i) {
+                bulk_queue.add_value("tick", i);
+            }
+            bulk_queue.delete_value();
+
+            binomial_priority_queue bulk_copy = bulk_queue;
+            std::cout << "Bulk copy size: " << bulk_copy.get_size() << std::endl;
+        }
+
     } catch (const char* error) {
         std::cerr << "Error: " << error << std::endl;
     }
 
     return 0;
 }
+#endif
@@ -0,0 +1,306 @@
+#ifndef BUFFERED_PRIORITY_QUEUE_H
+#define BUFFERED_PRIORITY_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "5z.h"
+
+// Есть ли у очереди пакетная вставка add_range по парам (строка, приоритет)
+template <typename Queue, typename = void>
+struct has_add_range : std::false_type {};
+
+template <typename Queue>
+struct has_add_range<Queue, std::void_t<decltype(std::declval<Queue&>().add_range(
+        std::declval<const std::pair<const char*, int>*>(),
+        std::declval<const std::pair<const char*, int>*>()))>> : std::true_type {};
+
+// Обёртка "много производителей - один потребитель" над любой очередью интерфейса priority_queue.
+// add_value можно вызывать из любых потоков: элемент без блокировок занимает ячейку кольцевого
+// буфера, строка копируется в саму ячейку (длинная - в отдельный блок). Остальные методы
+// вызывает только поток-потребитель: перед каждым обращением к куче он переносит накопленное
+// одной пачкой, через add_range, если очередь его поддерживает.
+// При переполнении кольца производитель не ждёт потребителя, а кладёт элемент в резервный
+// список под мьютексом
+template <typename Queue>
+class buffered_priority_queue final : public priority_queue {
+    static_assert(std::is_base_of_v<priority_queue, Queue>, "Queue must implement priority_queue");
+
+    static constexpr std::size_t INLINE_TEXT = 40;
+
+    // Ячейка кольца (алгоритм Вьюкова): sequence == позиция - свободна для записи,
+    // позиция + 1 - заполнена и ждёт потребителя
+    struct alignas(64) cell {
+        std::atomic<std::size_t> sequence;
+        int priority;
+        char* overflow;
+        char text[INLINE_TEXT];
+
+        [[nodiscard]] const char* c_str() const {
+            return overflow ? overflow : text;
+        }
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask;
+
+    alignas(64) std::atomic<std::size_t> tail;
+
+    // Поля потребителя
+    alignas(64) mutable std::size_t head;
+    mutable Queue queue;
+    mutable std::vector<std::pair<const char*, int>> batch;
+
+    mutable std::mutex spill_lock;
+    mutable std::vector<std::pair<std::string, int>> spill;
+    mutable std::atomic<bool> spill_pending;
+
+    static std::size_t round_up_capacity(int capacity) {
+        if (capacity <= 0) throw "Invalid size: must be positive";
+
+        std::size_t result = 1;
+        while (result < static_cast<std::size_t>(capacity)) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    void spill_value(const char* str, int priority) {
+        std::lock_guard<std::mutex> guard(spill_lock);
+        spill.emplace_back(str, priority);
+        spill_pending.store(true, std::memory_order_release);
+    }
+
+    // Вставляет пачку; consumed - сколько элементов с её начала попало в очередь, в том числе
+    // при исключении: add_range всех реализаций при ошибке оставляет в куче вставленный префикс
+    void insert_batch(std::size_t& consumed) const {
+        consumed = 0;
+        if (batch.empty()) return;
+
+        int before = queue.size();
+        try {
+            if constexpr (has_add_range<Queue>::value) {
+                queue.add_range(batch.data(), batch.data() + batch.size());
+            }
+            else {
+                for (const auto& item : batch) {
+                    queue.add_value(item.first, item.second);
+                    ++consumed;
+                }
+            }
+        }
+        catch (...) {
+            if constexpr (has_add_range<Queue>::value) {
+                consumed = static_cast<std::size_t>(queue.size() - before);
+            }
+            batch.clear();
+            throw;
+        }
+        consumed = batch.size();
+        batch.clear();
+    }
+
+    void release_cells(std::size_t first, std::size_t last) const {
+        for (std::size_t i = first; i < last; ++i) {
+            cell& source = cells[i & mask];
+            delete[] source.overflow;
+            source.overflow = nullptr;
+            source.sequence.store(i + mask + 1, std::memory_order_release);
+        }
+        head = last;
+    }
+
+    // Не вставленные из-за исключения элементы возвращаются в начало резервного списка
+    int drain_spill() const {
+        if (!spill_pending.load(std::memory_order_acquire)) return 0;
+
+        std::vector<std::pair<std::string, int>> taken;
+        {
+            std::lock_guard<std::mutex> guard(spill_lock);
+            taken.swap(spill);
+            spill_pending.store(false, std::memory_order_relaxed);
+        }
+
+        std::size_t consumed = 0;
+        try {
+            batch.reserve(taken.size());
+            for (const auto& item : taken) {
+                batch.emplace_back(item.first.c_str(), item.second);
+            }
+            insert_batch(consumed);
+        }
+        catch (...) {
+            batch.clear();
+            std::lock_guard<std::mutex> guard(spill_lock);
+            spill.insert(spill.begin(), std::make_move_iterator(taken.begin() + consumed),
+                         std::make_move_iterator(taken.end()));
+            spill_pending.store(true, std::memory_order_release);
+            throw;
+        }
+        return static_cast<int>(taken.size());
+    }
+
+public:
+    template <typename... Args>
+    explicit buffered_priority_queue(int ring_capacity, Args&&... args)
+        : cells(new cell[round_up_capacity(ring_capacity)]),
+          mask(round_up_capacity(ring_capacity) - 1),
+          tail(0),
+          head(0),
+          queue(std::forward<Args>(args)...),
+          spill_pending(false) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+            cells[i].overflow = nullptr;
+        }
+        batch.reserve(mask + 1);
+    }
+
+    buffered_priority_queue(const buffered_priority_queue&) = delete;
+    buffered_priority_queue& operator=(const buffered_priority_queue&) = delete;
+
+    ~buffered_priority_queue() override {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            delete[] cells[i].overflow;
+        }
+    }
+
+    // Потокобезопасная вставка
+    void add_value(const char* str, int priority) override {
+        if (!str) throw "Null pointer";
+        std::size_t length = std::strlen(str);
+        if (length == 0) throw "Empty string";
+
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        cell* target;
+        while (true) {
+            target = &cells[position & mask];
+            std::size_t sequence = target->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (difference < 0) {
+                spill_value(str, priority);
+                return;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        target->priority = priority;
+        if (length < INLINE_TEXT) {
+            std::memcpy(target->text, str, length + 1);
+        }
+        else {
+            target->overflow = new char[length + 1];
+            std::memcpy(target->overflow, str, length + 1);
+        }
+        target->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Переносит опубликованные элементы в очередь; возвращает их число. Только для потребителя
+    int drain() const {
+        std::size_t first = head;
+        std::size_t position = head;
+
+        // Ячейки освобождаются только после вставки: до неё очередь читает строки прямо из них
+        while (position - first <= mask) {
+            cell& source = cells[position & mask];
+            if (source.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+            batch.emplace_back(source.c_str(), source.priority);
+            ++position;
+        }
+
+        int moved = static_cast<int>(position - first);
+        std::size_t consumed = 0;
+        try {
+            insert_batch(consumed);
+        }
+        catch (...) {
+            release_cells(first, first + consumed);
+            throw;
+        }
+        release_cells(first, position);
+
+        return moved + drain_spill();
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        drain();
+        return queue.search_value();
+    }
+
+    void delete_value() override {
+        drain();
+        queue.delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        drain();
+        return queue.try_peek(str, priority);
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        drain();
+        return queue.try_pop(str, priority);
+    }
+
+    [[nodiscard]] int size() const override {
+        drain();
+        return queue.size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        drain();
+        return queue.pop_batch(count, out);
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        drain();
+        return queue.top_k(count, out);
+    }
+
+    // Вторая очередь тоже может быть буферизованной: тогда сначала опустошается её кольцо
+    priority_queue& merge(const priority_queue& second) override {
+        drain();
+        if (auto other_queue = dynamic_cast<const buffered_priority_queue*>(&second)) {
+            other_queue->drain();
+            queue.merge(static_cast<const priority_queue&>(other_queue->queue));
+        }
+        else {
+            queue.merge(second);
+        }
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        drain();
+        if (auto other_queue = dynamic_cast<buffered_priority_queue*>(&second)) {
+            other_queue->drain();
+            queue.merge(static_cast<priority_queue&&>(other_queue->queue));
+        }
+        else {
+            queue.merge(std::move(second));
+        }
+        return *this;
+    }
+
+    // Внутренняя очередь со всеми опубликованными элементами. Только для потребителя
+    [[nodiscard]] Queue& get_queue() {
+        drain();
+        return queue;
+    }
+};
+
+#endif //BUFFERED_PRIORITY_QUEUE_H
@@ -0,0 +1,213 @@
+// Очереди для нескольких потоков: ошибка ранга и пропускная способность MultiQueue против
+// одной кучи под мьютексом, задержка вставки у кольца перед кучей против мьютекса.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include "binary_priority_queue.cpp"
+#include "multi_priority_queue.h"
+#include "buffered_priority_queue.h"
+
+// Шарды MultiQueue из 8-арных куч: шаблон-шаблонный параметр ждёт три аргумента
+template <typename T, typename Priority, typename Compare>
+using oct_dary_priority_queue = basic_dary_priority_queue<T, Priority, Compare, 8>;
+
+struct rank_error_stats {
+    double mean;
+    int max;
+};
+
+// Ошибка ранга: сколько ещё лежащих в очереди элементов лучше извлечённого.
+// Приоритеты - перестановка 0..count-1, оставшиеся считаются деревом Фенвика
+template <typename Queue>
+rank_error_stats measure_rank_error(Queue& queue, int count, unsigned seed) {
+    std::vector<int> priorities(count);
+    std::iota(priorities.begin(), priorities.end(), 0);
+    std::shuffle(priorities.begin(), priorities.end(), std::mt19937(seed));
+
+    std::vector<int> fenwick(count + 1, 0);
+    auto update = [&](int priority, int delta) {
+        for (int i = priority + 1; i <= count; i += i & -i) fenwick[i] += delta;
+    };
+    auto count_below = [&](int priority) {
+        int sum = 0;
+        for (int i = priority; i > 0; i -= i & -i) sum += fenwick[i];
+        return sum;
+    };
+
+    for (int priority : priorities) {
+        queue.add_value(static_cast<std::uint64_t>(priority), priority);
+        update(priority, 1);
+    }
+
+    long long total_error = 0;
+    int max_error = 0;
+    int remaining = count;
+    std::uint64_t value;
+    int priority;
+    while (queue.try_extract(value, priority)) {
+        int error = remaining - count_below(priority + 1);
+        total_error += error;
+        if (error > max_error) max_error = error;
+        update(priority, -1);
+        --remaining;
+    }
+    return { static_cast<double>(total_error) / count, max_error };
+}
+
+// Смешанная нагрузка: потоки поровну вставляют и извлекают из предзаполненной очереди.
+// Возвращает миллионы операций в секунду
+template <typename Queue>
+double concurrent_mops(Queue& queue, int threads, int total_ops, int prefill) {
+    std::mt19937 generator(11);
+    for (int i = 0; i < prefill; ++i) {
+        queue.add_value(static_cast<std::uint64_t>(i), static_cast<int>(generator() >> 1));
+    }
+
+    int ops_per_thread = total_ops / threads;
+    std::atomic<bool> start_flag(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, &start_flag, ops_per_thread, t] {
+            std::mt19937 local(t + 1);
+            std::uint64_t value;
+            while (!start_flag.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < ops_per_thread; ++i) {
+                if (i & 1) {
+                    queue.try_extract(value);
+                }
+                else {
+                    queue.add_value(static_cast<std::uint64_t>(i), static_cast<int>(local() >> 1));
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    start_flag.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(ops_per_thread) * threads / static_cast<double>(elapsed.count());
+}
+
+struct latency_percentiles {
+    double p50;
+    double p99;
+    double p999;
+};
+
+// Задержка вставки у producers потоков, пока текущий поток извлекает всё вставленное
+template <typename Push, typename Pop>
+latency_percentiles producer_latency(int producers, int pushes_per_producer, Push push, Pop pop) {
+    std::vector<std::vector<long long>> samples(producers);
+    std::vector<std::thread> workers;
+    for (int p = 0; p < producers; ++p) {
+        samples[p].reserve(pushes_per_producer);
+        workers.emplace_back([&, p] {
+            std::mt19937 generator(p + 1);
+            for (int i = 0; i < pushes_per_producer; ++i) {
+                int priority = static_cast<int>(generator() >> 1);
+                auto start = std::chrono::steady_clock::now();
+                push("task", priority);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                samples[p].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            }
+        });
+    }
+
+    long long expected = static_cast<long long>(producers) * pushes_per_producer;
+    for (long long popped = 0; popped < expected;) {
+        if (pop()) {
+            ++popped;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<long long> all;
+    all.reserve(expected);
+    for (const auto& thread_samples : samples) {
+        all.insert(all.end(), thread_samples.begin(), thread_samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double fraction) {
+        return static_cast<double>(all[static_cast<std::size_t>(fraction * (all.size() - 1))]);
+    };
+    return { percentile(0.5), percentile(0.99), percentile(0.999) };
+}
+
+int main() {
+    try {
+        std::cout << "MultiQueue rank error (binary heap shards, 100000 pops)...\n";
+        for (int shards = 1; shards <= 128; shards *= 2) {
+            basic_multi_priority_queue<basic_binary_priority_queue, std::uint64_t> relaxed(shards);
+            rank_error_stats stats = measure_rank_error(relaxed, 100000, 5);
+            std::cout << "  shards = " << shards << ": mean " << stats.mean << ", max " << stats.max << "\n";
+        }
+
+        // Один шард - это одна двоичная куча под общим мьютексом; MultiQueue берёт по 2 шарда на поток
+        std::cout << "\nConcurrent throughput (Mops/s, 50% push / 50% pop, hardware threads: "
+                  << std::thread::hardware_concurrency() << ")...\n";
+        for (int threads = 1; threads <= 64; threads *= 2) {
+            basic_multi_priority_queue<basic_binary_priority_queue, std::uint64_t> global_lock(1);
+            basic_multi_priority_queue<basic_binary_priority_queue, std::uint64_t> binary_shards(2 * threads);
+            basic_multi_priority_queue<oct_dary_priority_queue, std::uint64_t> dary_shards(2 * threads);
+
+            double locked = concurrent_mops(global_lock, threads, 1000000, 100000);
+            double binary_sharded = concurrent_mops(binary_shards, threads, 1000000, 100000);
+            double dary_sharded = concurrent_mops(dary_shards, threads, 1000000, 100000);
+
+            std::cout << "  threads = " << threads << ": global lock " << locked
+                      << ", multiqueue binary " << binary_sharded << ", multiqueue 8-ary " << dary_sharded << "\n";
+        }
+
+        // Одна куча под мьютексом против кольца перед кучей; потребитель - текущий поток
+        std::cout << "\nProducer add_value latency (ns, p50/p99/p99.9, 100000 pushes per producer)...\n";
+        for (int producers = 1; producers <= 8; producers *= 2) {
+            binary_priority_queue locked_queue;
+            std::mutex queue_lock;
+            latency_percentiles locked = producer_latency(producers, 100000,
+                [&](const char* str, int priority) {
+                    std::lock_guard<std::mutex> guard(queue_lock);
+                    locked_queue.add_value(str, priority);
+                },
+                [&] {
+                    std::lock_guard<std::mutex> guard(queue_lock);
+                    if (locked_queue.is_empty()) return false;
+                    locked_queue.delete_value();
+                    return true;
+                });
+
+            buffered_priority_queue<binary_priority_queue> buffered_queue(65536);
+            latency_percentiles buffered = producer_latency(producers, 100000,
+                [&](const char* str, int priority) {
+                    buffered_queue.add_value(str, priority);
+                },
+                [&] {
+                    if (buffered_queue.size() == 0) return false;
+                    buffered_queue.delete_value();
+                    return true;
+                });
+
+            std::cout << "  producers = " << producers << ": mutex " << locked.p50 << "/" << locked.p99 << "/"
+                      << locked.p999 << ", ring " << buffered.p50 << "/" << buffered.p99 << "/" << buffered.p999 << "\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Опустошение двоичной и d-арных куч: выбор ребёнка ветвлением, скалярным циклом и SIMD.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <chrono>
+#include <cstdlib>
+#include "binary_priority_queue.cpp"
+
+// Нагрузка с преобладанием извлечений: count случайных вставок, затем полное опустошение.
+// Возвращает среднее время одного извлечения в наносекундах
+template <typename Queue>
+double pop_heavy_ns_per_pop(int count, unsigned seed) {
+    std::mt19937 generator(seed);
+    Queue queue;
+    queue.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        queue.add_value(static_cast<std::uint64_t>(i), static_cast<int>(generator() >> 1));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (!queue.is_empty()) {
+        queue.delete_value();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / count;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        // Размер самого большого прогона можно задать аргументом, например 100000000
+        // Двоичная куча выбирает ребёнка ветвлением, d-арные - скалярным циклом и векторно
+        std::cout << "Pop-heavy benchmark (ns/pop, 8-byte payload, SIMD: "
+                  << simd_level_name(supported_simd_level()) << ")...\n";
+        using quad_heap = basic_dary_priority_queue<std::uint64_t, int, std::less<int>, 4>;
+        using oct_heap = basic_dary_priority_queue<std::uint64_t, int, std::less<int>, 8>;
+        int max_elements = argc > 1 ? std::atoi(argv[1]) : 10000000;
+        for (int n = 1000000; n <= max_elements; n *= 10) {
+            double binary_time = pop_heavy_ns_per_pop<basic_binary_priority_queue<std::uint64_t>>(n, 7);
+
+            set_simd_level(simd_level::scalar);
+            double quad_scalar = pop_heavy_ns_per_pop<quad_heap>(n, 7);
+            double oct_scalar = pop_heavy_ns_per_pop<oct_heap>(n, 7);
+
+            set_simd_level(supported_simd_level());
+            double quad_simd = pop_heavy_ns_per_pop<quad_heap>(n, 7);
+            double oct_simd = pop_heavy_ns_per_pop<oct_heap>(n, 7);
+            set_simd_level(simd_level::scalar);
+
+            std::cout << "  n = " << n << ": binary " << binary_time
+                      << ", 4-ary scalar/simd " << quad_scalar << "/" << quad_simd
+                      << ", 8-ary scalar/simd " << oct_scalar << "/" << oct_simd << "\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,12 +1,29 @@
 #include <iostream>
+#include <algorithm>
 #include <cstring>
-#include "../../source/repos/second_sem_labs/priority_queue.h"
-
-class fibonacci_priority_queue final : public priority_queue {
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "5z.h"
+#include "node_pool.h"
+
+// Фибоначчиева куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Значения перемещаются в узлы и из них
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_fibonacci_priority_queue {
 private:
+    // Узлы выделяются из node_pool
     struct FibonacciNode {
-        char* value;
-        int priority;
+        T value;
+        Priority priority;
         int degree;
         bool marked;
         FibonacciNode* parent;
@@ -14,37 +31,23 @@ private:
         FibonacciNode* left;
         FibonacciNode* right;
 
-        FibonacciNode(const char* str, int p) : priority(p), degree(0), marked(false),
-                                               parent(nullptr), child(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                std::strcpy(value, str);
-            } else {
-                value = nullptr;
-            }
-            left = this;
-            right = this;
-        }
-
-        FibonacciNode(const FibonacciNode& other) : priority(other.priority), degree(other.degree),
-                                                   marked(other.marked), parent(nullptr), child(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
-            } else {
-                value = nullptr;
-            }
+        template <typename Value>
+        FibonacciNode(Value&& v, const Priority& p) : value(std::forward<Value>(v)), priority(p), degree(0),
+                                                     marked(false), parent(nullptr), child(nullptr) {
             left = this;
             right = this;
         }
 
-        ~FibonacciNode() {
-            delete[] value;
-        }
+        FibonacciNode(const FibonacciNode&) = delete;
+        FibonacciNode& operator=(const FibonacciNode&) = delete;
     };
 
+    // min_node - вершина кучи в порядке Compare
     FibonacciNode* min_node;
     int node_count;
+    node_pool* pool;
+    Compare compare;
+    std::vector<FibonacciNode*> degree_table; // переиспользуемый буфер для consolidate
 
 private:
     void insert_into_list(FibonacciNode*& list, FibonacciNode* node) {
@@ -74,8 +77,8 @@ private:
         node->right = node;
     }
 
+    // child уже отсоединён от корневого списка (см. consolidate)
     void link_trees(FibonacciNode* child, FibonacciNode* parent) {
-        remove_from_list(min_node, child);
         child->parent = parent;
         child->marked = false;
 
@@ -88,28 +91,29 @@ private:
     }
 
 
+    // Степень дерева из n узлов не превышает log_phi(n), отсюда размер таблицы
+    [[nodiscard]] int max_degree_bound() const {
+        const double golden_ratio = 1.6180339887498949;
+        return static_cast<int>(std::log(static_cast<double>(node_count) + 1) / std::log(golden_ratio)) + 2;
+    }
+
+    // Корни снимаются со списка по одному и сливаются через таблицу степеней,
+    // затем список собирается заново из таблицы - без копии корневого списка
     void consolidate() {
-        const int MAX_DEGREE = 45; // log_phi(2^32) ~ 45
-        FibonacciNode* degree_table[MAX_DEGREE] = {nullptr};
+        degree_table.assign(max_degree_bound(), nullptr);
 
-        FibonacciNode* nodes_to_process[min_node ? node_count : 1];
-        int count = 0;
+        FibonacciNode* current = min_node;
+        current->left->right = nullptr;
 
-        if (min_node) {
-            FibonacciNode* current = min_node;
-            do {
-                nodes_to_process[count++] = current;
-                current = current->right;
-            } while (current != min_node);
-        }
+        while (current) {
+            FibonacciNode* next = current->right;
+            current->left = current;
+            current->right = current;
 
-        for (int i = 0; i < count; ++i) {
-            FibonacciNode* current = nodes_to_process[i];
             int degree = current->degree;
-
             while (degree_table[degree]) {
                 FibonacciNode* other = degree_table[degree];
-                if (current->priority < other->priority) {
+                if (compare(current->priority, other->priority)) {
                     FibonacciNode* temp = current;
                     current = other;
                     other = temp;
@@ -119,13 +123,16 @@ private:
                 degree++;
             }
             degree_table[degree] = current;
+
+            current = next;
         }
 
         min_node = nullptr;
-        for (int i = 0; i < MAX_DEGREE; ++i) {
-            if (degree_table[i]) {
-                if (!min_node || degree_table[i]->priority > min_node->priority) {
-                    min_node = degree_table[i];
+        for (FibonacciNode* root : degree_table) {
+            if (root) {
+                insert_into_list(min_node, root);
+                if (compare(min_node->priority, root->priority)) {
+                    min_node = root;
                 }
             }
         }
@@ -151,143 +158,245 @@ private:
         }
     }
 
-    FibonacciNode* copy_node(FibonacciNode* node, FibonacciNode* parent) {
-        if (!node) return nullptr;
+    // Копирует кольцо братьев в list; каждый узел вставляется сразу, чтобы при исключении
+    // частичная копия оставалась достижимой. Узлы с детьми откладываются в pending
+    void copy_ring(const FibonacciNode* ring, FibonacciNode* parent, FibonacciNode*& list,
+                   std::vector<std::pair<const FibonacciNode*, FibonacciNode*>>& pending) {
+        const FibonacciNode* source = ring;
+        do {
+            FibonacciNode* node = pool->template create<FibonacciNode>(source->value, source->priority);
+            node->degree = source->degree;
+            node->marked = source->marked;
+            node->parent = parent;
+            insert_into_list(list, node);
+
+            if (source->child) {
+                pending.push_back({ source, node });
+            }
+            source = source->right;
+        } while (source != ring);
+    }
 
-        FibonacciNode* new_node = new FibonacciNode(node->value, node->priority);
-        new_node->degree = node->degree;
-        new_node->marked = node->marked;
-        new_node->parent = parent;
+    // Копирование леса без рекурсии. Первый скопированный корень - копия list,
+    // так что копия вершины оказывается на месте min_node
+    FibonacciNode* copy_roots(const FibonacciNode* list) {
+        if (!list) return nullptr;
+
+        std::vector<std::pair<const FibonacciNode*, FibonacciNode*>> pending;
+        FibonacciNode* result = nullptr;
+
+        try {
+            copy_ring(list, nullptr, result, pending);
+            while (!pending.empty()) {
+                const FibonacciNode* source = pending.back().first;
+                FibonacciNode* target = pending.back().second;
+                pending.pop_back();
+                copy_ring(source->child, target, target->child, pending);
+            }
+        }
+        catch (...) {
+            delete_roots(result);
+            throw;
+        }
+        return result;
+    }
 
-        if (node->child) {
-            FibonacciNode* child_current = node->child;
-            FibonacciNode* first_child = nullptr;
-            FibonacciNode* last_child = nullptr;
+    // Удаление без рекурсии и без дополнительной памяти: корневое кольцо размыкается
+    // в список по right, а кольцо детей удаляемого узла вклеивается перед остатком списка.
+    // Блоки возвращаются в пул одной цепочкой
+    void delete_roots(FibonacciNode* list) {
+        if (!list) return;
 
-            do {
-                FibonacciNode* new_child = copy_node(child_current, new_node);
-                if (!first_child) {
-                    first_child = new_child;
-                } else {
-                    last_child->right = new_child;
-                    new_child->left = last_child;
-                }
-                last_child = new_child;
-                child_current = child_current->right;
-            } while (child_current != node->child);
+        node_pool::teardown<FibonacciNode> batch(*pool);
+        list->left->right = nullptr;
 
-            first_child->left = last_child;
-            last_child->right = first_child;
-            new_node->child = first_child;
+        while (list) {
+            FibonacciNode* next = list->right;
+            if (FibonacciNode* child = list->child) {
+                child->left->right = next;
+                next = child;
+            }
+            batch.destroy(list);
+            list = next;
         }
-
-        return new_node;
     }
 
-    void delete_node(FibonacciNode* node) {
-        if (!node) return;
+    // Подклеивает чужой корневой список к своему за O(1), забирая узлы во владение
+    void splice_roots(FibonacciNode* other_min, int other_count) {
+        if (!other_min) return;
 
-        FibonacciNode* child = node->child;
-        if (child) {
-            FibonacciNode* current = child;
-            do {
-                FibonacciNode* next = current->right;
-                delete_node(current);
-                current = next;
-            } while (current != child);
+        if (min_node) {
+            FibonacciNode* this_left = min_node->left;
+            FibonacciNode* other_left = other_min->left;
+
+            this_left->right = other_min;
+            other_min->left = this_left;
+            other_left->right = min_node;
+            min_node->left = other_left;
+
+            if (compare(min_node->priority, other_min->priority)) {
+                min_node = other_min;
+            }
+        } else {
+            min_node = other_min;
         }
-        delete node;
+
+        node_count += other_count;
     }
 
     [[nodiscard]] int count_nodes(FibonacciNode* list) const {
-        if (!list) return 0;
         int count = 0;
-        FibonacciNode* current = list;
-        do {
-            count += 1 + count_nodes(current->child);
-            current = current->right;
-        } while (current != list);
-        return count;
-    }
+        std::vector<FibonacciNode*> pending;
+        if (list) pending.push_back(list);
 
-public:
-    fibonacci_priority_queue() : min_node(nullptr), node_count(0) {}
+        while (!pending.empty()) {
+            FibonacciNode* ring = pending.back();
+            pending.pop_back();
 
-    fibonacci_priority_queue(const fibonacci_priority_queue& other) : min_node(nullptr), node_count(other.node_count) {
-        if (other.min_node) {
-            FibonacciNode* current = other.min_node;
+            FibonacciNode* current = ring;
             do {
-                FibonacciNode* new_node = copy_node(current, nullptr);
-                insert_into_list(min_node, new_node);
-                if (!min_node || new_node->priority > min_node->priority) {
-                    min_node = new_node;
-                }
+                ++count;
+                if (current->child) pending.push_back(current->child);
                 current = current->right;
-            } while (current != other.min_node);
+            } while (current != ring);
         }
+        return count;
     }
 
-    fibonacci_priority_queue& operator=(const fibonacci_priority_queue& other) {
+public:
+    basic_fibonacci_priority_queue() : basic_fibonacci_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_fibonacci_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : min_node(nullptr), node_count(0), pool(&shared_pool), compare(order) {}
+
+    basic_fibonacci_priority_queue(const basic_fibonacci_priority_queue& other)
+        : min_node(nullptr), node_count(other.node_count), pool(other.pool), compare(other.compare) {
+        min_node = copy_roots(other.min_node);
+    }
+
+    basic_fibonacci_priority_queue& operator=(const basic_fibonacci_priority_queue& other) {
         if (this != &other) {
-            delete_node(min_node);
-            min_node = nullptr;
+            FibonacciNode* copy = copy_roots(other.min_node);
+            delete_roots(min_node);
+            min_node = copy;
             node_count = other.node_count;
-
-            if (other.min_node) {
-                FibonacciNode* current = other.min_node;
-                do {
-                    FibonacciNode* new_node = copy_node(current, nullptr);
-                    insert_into_list(min_node, new_node);
-                    if (!min_node || new_node->priority > min_node->priority) {
-                        min_node = new_node;
-                    }
-                    current = current->right;
-                } while (current != other.min_node);
-            }
+            compare = other.compare;
         }
         return *this;
     }
 
-    fibonacci_priority_queue(fibonacci_priority_queue&& other) noexcept
-        : min_node(other.min_node), node_count(other.node_count) {
+    basic_fibonacci_priority_queue(basic_fibonacci_priority_queue&& other) noexcept
+        : min_node(other.min_node), node_count(other.node_count), pool(other.pool), compare(other.compare) {
         other.min_node = nullptr;
         other.node_count = 0;
     }
 
-    fibonacci_priority_queue& operator=(fibonacci_priority_queue&& other) noexcept {
+    basic_fibonacci_priority_queue& operator=(basic_fibonacci_priority_queue&& other) noexcept {
         if (this != &other) {
-            delete_node(min_node);
+            delete_roots(min_node);
             min_node = other.min_node;
             node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
             other.min_node = nullptr;
             other.node_count = 0;
         }
         return *this;
     }
 
-    ~fibonacci_priority_queue() {
-        delete_node(min_node);
+    ~basic_fibonacci_priority_queue() {
+        delete_roots(min_node);
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
+    // Дескриптор элемента: узлы не перемещаются, поэтому он остаётся действительным,
+    // пока элемент не удалён из очереди (delete_value/erase). Копии очереди его не разделяют
+    class handle {
+        FibonacciNode* node;
+        explicit handle(FibonacciNode* n) : node(n) {}
+        friend class basic_fibonacci_priority_queue;
+    public:
+        handle() : node(nullptr) {}
+
+        [[nodiscard]] bool is_valid() const {
+            return node != nullptr;
+        }
+
+        [[nodiscard]] const Priority& priority() const {
+            if (!node) throw "Invalid handle";
+            return node->priority;
+        }
 
-        FibonacciNode* new_node = new FibonacciNode(str, priority);
+        [[nodiscard]] const T& value() const {
+            if (!node) throw "Invalid handle";
+            return node->value;
+        }
+    };
+
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        insert_value(std::forward<Value>(value), priority);
+    }
+
+    template <typename Value>
+    handle insert_value(Value&& value, const Priority& priority) {
+        FibonacciNode* new_node = pool->template create<FibonacciNode>(std::forward<Value>(value), priority);
         insert_into_list(min_node, new_node);
 
-        if (!min_node || new_node->priority > min_node->priority) {
+        if (compare(min_node->priority, new_node->priority)) {
             min_node = new_node;
         }
         node_count++;
+        return handle(new_node);
     }
 
-    [[nodiscard]] const char* search_value() const override {
+    // Продвижение элемента к вершине за O(1) амортизированно: узел вырезается к корням,
+    // если нарушает порядок кучи относительно родителя. Для std::greater это decrease-key
+    void increase_priority(handle element, const Priority& new_priority) {
+        FibonacciNode* node = element.node;
+        if (!node) throw "Invalid handle";
+        if (compare(new_priority, node->priority)) throw "New priority is lower than current";
+
+        node->priority = new_priority;
+
+        FibonacciNode* parent = node->parent;
+        if (parent && compare(parent->priority, node->priority)) {
+            cut(node, parent);
+            cascading_cut(parent);
+        }
+
+        if (compare(min_node->priority, node->priority)) {
+            min_node = node;
+        }
+    }
+
+    // Удаление произвольного элемента: узел поднимается в корневой список
+    // как будто с бесконечным приоритетом и извлекается как вершина
+    void erase(handle element) {
+        FibonacciNode* node = element.node;
+        if (!node) throw "Invalid handle";
+
+        FibonacciNode* parent = node->parent;
+        if (parent) {
+            cut(node, parent);
+            cascading_cut(parent);
+        }
+
+        min_node = node;
+        delete_value();
+    }
+
+    [[nodiscard]] const T& search_value() const {
         if (!min_node) throw "Queue is empty";
         return min_node->value;
     }
 
-    void delete_value() override {
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!min_node) throw "Queue is empty";
+        return min_node->priority;
+    }
+
+    void delete_value() {
         if (!min_node) throw "Queue is empty";
 
         FibonacciNode* old_min = min_node;
@@ -305,43 +414,133 @@ public:
         remove_from_list(min_node, old_min);
         node_count--;
 
-        if (old_min == old_min->right) {
-            min_node = nullptr;
-        } else {
-            min_node = old_min->right;
+        if (min_node) {
             consolidate();
         }
 
-        delete old_min;
+        pool->destroy(old_min);
     }
 
-    priority_queue& merge(const priority_queue& second) override {
-        const fibonacci_priority_queue* other_queue =
-            dynamic_cast<const fibonacci_priority_queue*>(&second);
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!min_node) throw "Queue is empty";
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+        T value = std::move(min_node->value);
+        delete_value();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка: каждый узел за O(1) ложится в корневой список, деревья
+    // собирает первое извлечение. make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        for (; first != last; ++first) {
+            insert_value(make_value(first->first), first->second);
         }
+    }
 
-        if (!other_queue->min_node) return *this;
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
 
-        if (min_node) {
-            FibonacciNode* this_left = min_node->left;
-            FibonacciNode* other_left = other_queue->min_node->left;
+    // Обход всех элементов: кольца корней и детей с явным стеком, visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const FibonacciNode*> rings;
+        if (min_node) rings.push_back(min_node);
 
-            this_left->right = other_queue->min_node;
-            other_queue->min_node->left = this_left;
-            other_left->right = min_node;
-            min_node->left = other_left;
+        while (!rings.empty()) {
+            const FibonacciNode* ring = rings.back();
+            rings.pop_back();
 
-            if (other_queue->min_node->priority > min_node->priority) {
-                min_node = other_queue->min_node;
+            const FibonacciNode* node = ring;
+            do {
+                visit(node->value, node->priority);
+                if (node->child) rings.push_back(node->child);
+                node = node->right;
+            } while (node != ring);
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && min_node; ++taken) {
+            consume(std::move(min_node->value), min_node->priority);
+            delete_value();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Фронт кандидатов начинается с корневого списка; выданный узел добавляет в него своё
+    // кольцо детей. Корневой список после вставок без извлечений длинный: он просматривается
+    // целиком один раз, дальше O(log) на элемент
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const FibonacciNode* first, const FibonacciNode* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const FibonacciNode*> frontier;
+        if (count > 0 && min_node) {
+            const FibonacciNode* root = min_node;
+            do {
+                frontier.push_back(root);
+                root = root->right;
+            } while (root != min_node);
+            std::make_heap(frontier.begin(), frontier.end(), lower);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const FibonacciNode* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            ++visited;
+
+            if (const FibonacciNode* child = node->child) {
+                do {
+                    frontier.push_back(child);
+                    std::push_heap(frontier.begin(), frontier.end(), lower);
+                    child = child->right;
+                } while (child != node->child);
             }
-        } else {
-            min_node = other_queue->min_node;
+        }
+        return visited;
+    }
+
+    basic_fibonacci_priority_queue& merge(const basic_fibonacci_priority_queue& other) {
+        // Корни донора копируются в свой пул: иначе обе очереди владели бы одними узлами
+        basic_fibonacci_priority_queue donor(*pool, compare);
+        donor = other;
+        return merge(std::move(donor));
+    }
+
+    // Слияние за O(1): корневой список донора подклеивается к своему, донор остаётся пустым
+    basic_fibonacci_priority_queue& merge(basic_fibonacci_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_fibonacci_priority_queue&>(other));
+            other = basic_fibonacci_priority_queue(*other.pool, other.compare);
+            return *this;
         }
 
-        node_count += other_queue->node_count;
+        splice_roots(other.min_node, other.node_count);
+        other.min_node = nullptr;
+        other.node_count = 0;
         return *this;
     }
 
@@ -353,14 +552,23 @@ public:
         return node_count;
     }
 
-    [[nodiscard]] fibonacci_priority_queue meld(const fibonacci_priority_queue& other) const {
-        fibonacci_priority_queue result = *this;
-        fibonacci_priority_queue temp = other;
-        result.merge(temp);
+    [[nodiscard]] int size() const {
+        return node_count;
+    }
+
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
+    }
+
+    [[nodiscard]] basic_fibonacci_priority_queue meld(const basic_fibonacci_priority_queue& other) const {
+        basic_fibonacci_priority_queue result = *this;
+        basic_fibonacci_priority_queue temp(*pool, compare);
+        temp = other;
+        result.merge(std::move(temp));
         return result;
     }
 
-    friend void print_fibonacci_queue(const fibonacci_priority_queue& queue, const char* name) {
+    friend void print_fibonacci_queue(const basic_fibonacci_priority_queue& queue, const char* name) {
         std::cout << name << " (size: " << queue.get_size() << "):\n";
 
         if (queue.min_node) {
@@ -368,7 +576,7 @@ public:
             int tree_count = 0;
             do {
                 std::cout << "Tree " << ++tree_count << ": ";
-                fibonacci_priority_queue::print_tree(std::cout, current, 1);
+                basic_fibonacci_priority_queue::print_tree(std::cout, current, 1);
                 current = current->right;
             } while (current != queue.min_node);
         } else {
@@ -385,7 +593,7 @@ private:
         do {
             for (int i = 0; i < depth; ++i) os << "  ";
             os << "[Prio: " << current->priority
-               << ", Val: " << (current->value ? current->value : "null")
+               << ", Val: " << current->value
                << ", Deg: " << current->degree
                << (current->marked ? ", Marked" : "") << "]\n";
 
@@ -398,7 +606,193 @@ private:
     }
 };
 
-int main() {
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class fibonacci_priority_queue final : public basic_fibonacci_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_fibonacci_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        insert_value(str, priority);
+    }
+
+    handle insert_value(const char* str, int priority) {
+        return base::insert_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        const fibonacci_priority_queue* other_queue =
+            dynamic_cast<const fibonacci_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        fibonacci_priority_queue* other_queue = dynamic_cast<fibonacci_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] fibonacci_priority_queue meld(const fibonacci_priority_queue& other) const {
+        fibonacci_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+// Граф в формате списков смежности, упакованных в массивы (CSR)
+struct weighted_graph {
+    int vertex_count;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<int> weights;
+};
+
+weighted_graph make_random_graph(int vertex_count, int edges_per_vertex, unsigned seed) {
+    std::mt19937 generator(seed);
+    weighted_graph graph;
+    graph.vertex_count = vertex_count;
+    graph.offsets.reserve(vertex_count + 1);
+    graph.offsets.push_back(0);
+
+    for (int v = 0; v < vertex_count; ++v) {
+        for (int e = 0; e < edges_per_vertex; ++e) {
+            graph.targets.push_back(static_cast<int>(generator() % vertex_count));
+            graph.weights.push_back(1 + static_cast<int>(generator() % 100));
+        }
+        graph.offsets.push_back(static_cast<int>(graph.targets.size()));
+    }
+    return graph;
+}
+
+// Дейкстра на фибоначчиевой куче: вершина хранится в узле как есть, приоритет - расстояние,
+// порядок std::greater ставит ближайшую вершину наверх, улучшение пути - increase_priority
+std::vector<int> dijkstra_fibonacci(const weighted_graph& graph, int source) {
+    using distance_queue = basic_fibonacci_priority_queue<int, int, std::greater<int>>;
+    std::vector<int> dist(graph.vertex_count, INT_MAX);
+    std::vector<distance_queue::handle> handles(graph.vertex_count);
+    std::vector<bool> done(graph.vertex_count, false);
+    distance_queue queue;
+
+    dist[source] = 0;
+    handles[source] = queue.insert_value(source, 0);
+
+    while (!queue.is_empty()) {
+        int v = queue.extract_value();
+        handles[v] = distance_queue::handle();
+        done[v] = true;
+
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            int candidate = dist[v] + graph.weights[e];
+            if (done[u] || candidate >= dist[u]) continue;
+
+            dist[u] = candidate;
+            if (handles[u].is_valid()) {
+                queue.increase_priority(handles[u], candidate);
+            }
+            else {
+                handles[u] = queue.insert_value(u, candidate);
+            }
+        }
+    }
+    return dist;
+}
+
+// Дейкстра на двоичной куче с ленивым удалением устаревших записей
+std::vector<int> dijkstra_lazy_binary(const weighted_graph& graph, int source) {
+    using entry = std::pair<int, int>;
+    std::vector<int> dist(graph.vertex_count, INT_MAX);
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+
+    dist[source] = 0;
+    queue.push({ 0, source });
+
+    while (!queue.empty()) {
+        entry top = queue.top();
+        queue.pop();
+        if (top.first != dist[top.second]) continue;
+
+        int v = top.second;
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            int candidate = dist[v] + graph.weights[e];
+            if (candidate < dist[u]) {
+                dist[u] = candidate;
+                queue.push({ candidate, u });
+            }
+        }
+    }
+    return dist;
+}
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+int main(int argc, char* argv[]) {
     try {
         std::cout << "Fibonacci Queue Basic Operations\n";
         std::cout << "-----------------------------------------\n";
@@ -415,6 +809,35 @@ int main() {
         fib_queue.delete_value();
         print_fibonacci_queue(fib_queue, "Fibonacci Queue after delete");
 
+        std::cout << "Key update operations\n";
+        std::cout << "-----------------------------\n";
+
+        fibonacci_priority_queue::handle task_v = fib_queue.insert_value("Task V", 5);
+        fibonacci_priority_queue::handle task_u = fib_queue.insert_value("Task U", 10);
+        fib_queue.delete_value();
+        fib_queue.increase_priority(task_v, 100);
+        std::cout << "Max after raising Task V to 100: " << fib_queue.search_value() << "\n";
+        fib_queue.erase(task_u);
+        print_fibonacci_queue(fib_queue, "Fibonacci Queue after erasing Task U");
+
+        std::cout << "Dijkstra benchmark\n";
+        std::cout << "--------------------------\n";
+
+        weighted_graph graph = make_random_graph(100000, 10, 2024);
+
+        auto fib_start = std::chrono::steady_clock::now();
+        std::vector<int> fib_dist = dijkstra_fibonacci(graph, 0);
+        auto fib_finish = std::chrono::steady_clock::now();
+
+        std::vector<int> lazy_dist = dijkstra_lazy_binary(graph, 0);
+        auto lazy_finish = std::chrono::steady_clock::now();
+
+        std::cout << "Fibonacci heap (increase_priority): "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(fib_finish - fib_start).count() << " ms\n";
+        std::cout << "Binary heap (lazy deletion): "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(lazy_finish - fib_finish).count() << " ms\n";
+        std::cout << "Distances match: " << (fib_dist == lazy_dist ? "true" : "false") << "\n\n";
+
         std::cout << "Merge Operations\n";
         std::cout << "------------------------\n";
 
@@ -431,6 +854,38 @@ int main() {
         auto fib_result = fib_queue.meld(fib_queue2);
         print_fibonacci_queue(fib_result, "Fibonacci Meld Result");
 
+        std::cout << "Consolidate stress test\n";
+        std::cout << "-------------------------------\n";
+
+        // После массовой вставки все элементы лежат в корневом списке,
+        // и первое извлечение консолидирует его целиком. Размер по умолчанию
+        // укладывается в память любой машины; большие прогоны задаются аргументом
+        int stress_size = argc > 1 ? std::atoi(argv[1]) : 1000000;
+        {
+            fibonacci_priority_queue stress_queue;
+            std::mt19937 generator(99);
+            for (int i = 0; i < stress_size; ++i) {
+                stress_queue.add_value("bulk", static_cast<int>(generator() % 1000000));
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            stress_queue.delete_value();
+            auto finish = std::chrono::steady_clock::now();
+
+            std::cout << "First pop after " << stress_queue.get_size() + 1 << " inserts: "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() << " ms\n";
+
+            // Копирование и удаление консолидированного леса идут без рекурсии
+            start = std::chrono::steady_clock::now();
+            {
+                fibonacci_priority_queue stress_copy = stress_queue;
+                std::cout << "Copy size: " << stress_copy.get_size() << "\n";
+            }
+            finish = std::chrono::steady_clock::now();
+            std::cout << "Copy and teardown: "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() << " ms\n";
+        }
+
     }
     catch (const char* msg) {
         std::cerr << "Error: " << msg << "\n";
@@ -439,3 +894,4 @@ int main() {
 
     return 0;
 }
+#endif
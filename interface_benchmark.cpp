@@ -0,0 +1,105 @@
+// Выдача задач через интерфейс priority_queue: поштучные вызовы против пакетных
+// pop_batch/top_k и опрос пустой очереди исключением против try_pop.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <chrono>
+#include "binary_priority_queue.cpp"
+
+// Рабочий опрашивает очередь через интерфейс polls раз; каждый fill_every-й опрос
+// перед этим приходит одна задача, остальные застают очередь пустой. Наносекунды на опрос
+template <typename Poll>
+double poll_ns_per_call(int polls, int fill_every, Poll poll) {
+    binary_priority_queue queue;
+    priority_queue& worker = queue;
+    int found = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < polls; ++i) {
+        if (fill_every > 0 && i % fill_every == 0) {
+            queue.add_value("job", i);
+        }
+        if (poll(worker)) ++found;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    int expected = fill_every > 0 ? (polls + fill_every - 1) / fill_every : 0;
+    if (found != expected) throw "Poll lost a task";
+    return static_cast<double>(elapsed.count()) / polls;
+}
+
+// Диспетчер забирает по batch задач за такт через интерфейс: поштучно search_value +
+// delete_value или одним pop_batch. Наносекунды на задачу при опустошении queue_size элементов
+template <typename Pull>
+double dispatch_ns_per_task(int queue_size, int batch, Pull pull) {
+    std::mt19937 generator(11);
+    binary_priority_queue queue;
+    queue.reserve(queue_size);
+    for (int i = 0; i < queue_size; ++i) {
+        queue.add_value("task", static_cast<int>(generator() >> 1));
+    }
+
+    std::vector<std::pair<std::string, int>> tick;
+    tick.reserve(batch);
+    priority_queue& dispatcher = queue;
+    auto start = std::chrono::steady_clock::now();
+    while (dispatcher.size() > 0) {
+        tick.clear();
+        pull(dispatcher, batch, tick);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / queue_size;
+}
+
+int main() {
+    try {
+        std::cout << "Dispatcher pulls through the interface (ns/task, 1000000 tasks)...\n";
+        for (int batch_size = 64; batch_size <= 256; batch_size *= 4) {
+            double one_by_one = dispatch_ns_per_task(1000000, batch_size,
+                [](priority_queue& queue, int count, std::vector<std::pair<std::string, int>>& tick) {
+                    for (int i = 0; i < count && queue.size() > 0; ++i) {
+                        tick.emplace_back(queue.search_value(), 0);
+                        queue.delete_value();
+                    }
+                });
+            double batched = dispatch_ns_per_task(1000000, batch_size,
+                [](priority_queue& queue, int count, std::vector<std::pair<std::string, int>>& tick) {
+                    queue.pop_batch(count, tick);
+                });
+            double peeked = dispatch_ns_per_task(1000000, batch_size,
+                [](priority_queue& queue, int count, std::vector<std::pair<std::string, int>>& tick) {
+                    queue.top_k(count, tick);
+                    queue.pop_batch(count, tick);
+                });
+            std::cout << "  batch = " << batch_size << ": search+delete " << one_by_one
+                      << ", pop_batch " << batched << ", top_k then pop_batch " << peeked << "\n";
+        }
+
+        // Пустая очередь: исключение из search_value против try_pop
+        std::cout << "\nPolling through the interface (ns/poll, 1000000 polls)...\n";
+        for (int fill_every : { 0, 10, 1 }) {
+            std::string task;
+            int task_priority = 0;
+            double throwing = poll_ns_per_call(1000000, fill_every, [&](priority_queue& queue) {
+                try {
+                    task = queue.search_value();
+                    queue.delete_value();
+                    return true;
+                }
+                catch (const char*) {
+                    return false;
+                }
+            });
+            double non_throwing = poll_ns_per_call(1000000, fill_every, [&](priority_queue& queue) {
+                return queue.try_pop(task, task_priority);
+            });
+            std::cout << "  " << (fill_every == 0 ? "always empty" : fill_every == 10 ? "1 task per 10 polls" : "task every poll")
+                      << ": throw/catch " << throwing << ", try_pop " << non_throwing << "\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,110 +1,198 @@
-#include "C:\Users\arnau\source\repos\second_sem_labs\priority_queue.h"
+#include "5z.h"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstring>
-
-class leftist_priority_queue final : public priority_queue {
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "node_pool.h"
+
+// Левосторонняя куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Значения перемещаются в узлы и из них
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_leftist_priority_queue {
 private:
+    // Узлы выделяются из node_pool и разделяются между копиями очереди:
+    // references - число указателей на узел (корни очередей и родители)
     struct Node {
-        char* value;
-        int priority;
+        T value;
+        Priority priority;
         int rank;
+        std::atomic<int> references;
         Node* left;
         Node* right;
 
-        Node(const char* str, int p) : priority(p), rank(1), left(nullptr), right(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                strcpy(value, str);
-            }
-            else {
-                value = nullptr;
-            }
-        }
-
-        Node(const Node& other) : priority(other.priority), rank(other.rank),
-            left(nullptr), right(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
-            }
-            else {
-                value = nullptr;
-            }
-        }
-
-        Node& operator=(const Node& other) {
-            if (this != &other) {
-                delete[] value;
-                priority = other.priority;
-                rank = other.rank;
-                if (other.value) {
-                    value = new char[std::strlen(other.value) + 1];
-                    std::strcpy(value, other.value);
-                }
-                else {
-                    value = nullptr;
-                }
-            }
-            return *this;
-        }
+        template <typename Value>
+        Node(Value&& v, const Priority& p)
+            : value(std::forward<Value>(v)), priority(p), rank(1), references(1), left(nullptr), right(nullptr) {}
 
-        ~Node() {
-            delete[] value;
-        }
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
     };
 
     Node* root;
+    int node_count;
+    node_pool* pool;
+    Compare compare;
 
 private:
     [[nodiscard]] int get_rank(Node* node) const {
         return node ? node->rank : 0;
     }
 
-    Node* merge_nodes(Node* node1, Node* node2) {
+    static Node* acquire(Node* node) {
+        if (node) node->references.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    // Счётчики ссылок атомарны: копия очереди и её источник могут читаться и разрушаться
+    // в разных потоках. Узел с единственной ссылкой видит только эта очередь, и его можно
+    // менять на месте; освобождает узел тот, кто снял последнюю ссылку
+    static bool is_shared(const Node* node) {
+        return node->references.load(std::memory_order_acquire) > 1;
+    }
+
+    static bool drop_reference(Node* node) {
+        return node->references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // Копирование при записи: узел, на который ссылается кто-то ещё, перед изменением
+    // заменяется копией, разделяющей с ним оба поддерева. Изменения идут от корня вниз,
+    // поэтому копируется только изменяемый путь, а остальное дерево остаётся общим.
+    // Очередь некопируемых значений скопировать нельзя, и её узлы никогда не разделены
+    Node* own(Node* node) const {
+        if constexpr (std::is_copy_constructible_v<T>) {
+            if (is_shared(node)) {
+                Node* copy = copy_node(node);
+                copy->left = acquire(node->left);
+                copy->right = acquire(node->right);
+                delete_tree(node);
+                return copy;
+            }
+        }
+        return node;
+    }
+
+    // Узлы другого пула разделять нельзя - их придётся вернуть в чужой пул
+    [[nodiscard]] Node* share_tree(const basic_leftist_priority_queue& other) const {
+        return other.pool == pool ? acquire(other.root) : copy_tree(other.root);
+    }
+
+    // Вершина перемещается из узла, только если её не видят другие копии очереди
+    [[nodiscard]] T take_top_value() {
+        if constexpr (std::is_copy_constructible_v<T>) {
+            if (is_shared(root)) return root->value;
+        }
+        return std::move(root->value);
+    }
+
+    // Слияние без рекурсии: спуск по правым путям с запоминанием узлов,
+    // затем подъём с пересчётом рангов. Правый путь левосторонней кучи
+    // не длиннее log2(n + 1), так что двух путей по 32 узла хватает для int-размеров
+    Node* merge_nodes(Node* node1, Node* node2) const {
         if (!node1) return node2;
         if (!node2) return node1;
 
-        if (node1->priority < node2->priority) {
-            Node* temp = node1;
-            node1 = node2;
-            node2 = temp;
+        const int MAX_PATH = 64;
+        Node* path[MAX_PATH];
+        int depth = 0;
+
+        Node* result = nullptr;
+        Node** link = &result;
+
+        while (node1 && node2) {
+            if (compare(node1->priority, node2->priority)) {
+                std::swap(node1, node2);
+            }
+
+            node1 = own(node1);
+            *link = node1;
+            path[depth++] = node1;
+            link = &node1->right;
+            node1 = node1->right;
         }
+        *link = node1 ? node1 : node2;
 
-        node1->right = merge_nodes(node1->right, node2);
-        
-        int left_rank = node1->left ? node1->left->rank : 0;
-        int right_rank = node1->right ? node1->right->rank : 0;
+        while (depth > 0) {
+            Node* current = path[--depth];
 
-        if (left_rank < right_rank) {
-            Node* temp = node1->left;
-            node1->left = node1->right;
-            node1->right = temp;
+            if (get_rank(current->left) < get_rank(current->right)) {
+                std::swap(current->left, current->right);
+            }
+            current->rank = get_rank(current->right) + 1;
         }
 
-        node1->rank = (node1->right ? node1->right->rank : 0) + 1;
-        return node1;
+        return result;
+    }
+
+    [[nodiscard]] Node* copy_node(const Node* source) const {
+        Node* node = pool->template create<Node>(source->value, source->priority);
+        node->rank = source->rank;
+        return node;
     }
 
     [[nodiscard]] Node* copy_tree(const Node* node) const {
         if (!node) return nullptr;
-        Node* new_node = new Node(node->value, node->priority);
-        new_node->rank = node->rank;
-        new_node->left = copy_tree(node->left);
-        new_node->right = copy_tree(node->right);
-        return new_node;
-    }
 
-    void delete_tree(Node* node) {
-        if (node) {
-            delete_tree(node->left);
-            delete_tree(node->right);
-            delete node;
+        Node* new_root = copy_node(node);
+        try {
+            std::vector<std::pair<const Node*, Node*>> pending;
+            pending.push_back({ node, new_root });
+
+            while (!pending.empty()) {
+                const Node* source = pending.back().first;
+                Node* target = pending.back().second;
+                pending.pop_back();
+
+                if (source->left) {
+                    target->left = copy_node(source->left);
+                    pending.push_back({ source->left, target->left });
+                }
+                if (source->right) {
+                    target->right = copy_node(source->right);
+                    pending.push_back({ source->right, target->right });
+                }
+            }
+        }
+        catch (...) {
+            delete_tree(new_root);
+            throw;
         }
+
+        return new_root;
     }
 
-    [[nodiscard]] int count_nodes(Node* node) const {
-        if (!node) return 0;
-        return 1 + count_nodes(node->left) + count_nodes(node->right);
+    // Снимает ссылку на дерево. Узлы, оставшиеся без ссылок, удаляются поворотами:
+    // левый ребёнок поднимается над родителем, пока левых детей не останется, после чего
+    // узел удаляется и обход идёт вправо. Живой ребёнок только теряет ссылку, его
+    // поддерево остаётся другим копиям. Опущенный вправо узел получает ссылку от нового
+    // родителя, чтобы снять её при удалении родителя
+    void delete_tree(Node* node) const {
+        if (!node || !drop_reference(node)) return;
+
+        node_pool::teardown<Node> batch(*pool);
+        while (node) {
+            if (Node* left = node->left) {
+                if (!drop_reference(left)) {
+                    node->left = nullptr;
+                    continue;
+                }
+                node->left = left->right;
+                node->references.store(1, std::memory_order_relaxed);
+                left->right = node;
+                node = left;
+            }
+            else {
+                Node* right = node->right;
+                batch.destroy(node);
+                node = right && drop_reference(right) ? right : nullptr;
+            }
+        }
     }
 
     void print_tree(std::ostream& os, Node* node, int depth = 0) const {
@@ -115,109 +203,269 @@ private:
             os << "    ";
         }
 
-        os << "[" << node->priority << ": " << (node->value ? node->value : "null")
+        os << "[" << node->priority << ": " << node->value
             << ", rank=" << node->rank << "]\n";
 
         print_tree(os, node->left, depth + 1);
     }
 
 public:
-    leftist_priority_queue() : root(nullptr) {}
-
-    leftist_priority_queue(const leftist_priority_queue& other) : root(nullptr) {
-        if (other.root) {
-            root = copy_tree(other.root);
-        }
+    basic_leftist_priority_queue() : basic_leftist_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_leftist_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : root(nullptr), node_count(0), pool(&shared_pool), compare(order) {}
+
+    // Копия - снимок за O(1): узлы разделяются, а последующие изменения любой из очередей
+    // копируют только свой путь слияния длиной O(log n)
+    // Копию можно читать и разрушать в другом потоке, пока источник меняется в своём,
+    // если узлы лежат в общем пуле процесса: явно созданный node_pool однопоточный
+    basic_leftist_priority_queue(const basic_leftist_priority_queue& other)
+        : root(acquire(other.root)), node_count(other.node_count), pool(other.pool), compare(other.compare) {
+        static_assert(std::is_copy_constructible_v<T>, "queue copies share nodes and need copyable values");
     }
 
-    leftist_priority_queue& operator=(const leftist_priority_queue& other) {
+    basic_leftist_priority_queue& operator=(const basic_leftist_priority_queue& other) {
         if (this != &other) {
+            Node* copy = share_tree(other);
             delete_tree(root);
-            root = other.root ? copy_tree(other.root) : nullptr;
+            root = copy;
+            node_count = other.node_count;
+            compare = other.compare;
         }
         return *this;
     }
 
-    leftist_priority_queue(leftist_priority_queue&& other) noexcept : root(other.root) {
+    basic_leftist_priority_queue(basic_leftist_priority_queue&& other) noexcept
+        : root(other.root), node_count(other.node_count), pool(other.pool), compare(other.compare) {
         other.root = nullptr;
+        other.node_count = 0;
     }
 
-    leftist_priority_queue& operator=(leftist_priority_queue&& other) noexcept {
+    basic_leftist_priority_queue& operator=(basic_leftist_priority_queue&& other) noexcept {
         if (this != &other) {
             delete_tree(root);
             root = other.root;
+            node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
             other.root = nullptr;
+            other.node_count = 0;
         }
         return *this;
     }
 
-    ~leftist_priority_queue() {
+    ~basic_leftist_priority_queue() {
         delete_tree(root);
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
-
-        Node* new_node = new Node(str, priority);
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        Node* new_node = pool->template create<Node>(std::forward<Value>(value), priority);
         root = merge_nodes(root, new_node);
+        node_count++;
     }
 
-    [[nodiscard]] const char* search_value() const override {
+    [[nodiscard]] const T& search_value() const {
         if (!root) throw "Queue is empty";
         return root->value;
     }
 
-    void delete_value() override {
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!root) throw "Queue is empty";
+        return root->priority;
+    }
+
+    void delete_value() {
         if (!root) throw "Queue is empty";
 
-        Node* old_root = root;
-        root = merge_nodes(root->left, root->right);
-        old_root->left = nullptr;
-        old_root->right = nullptr;
-        delete old_root;
+        Node* left = root->left;
+        Node* right = root->right;
+        if (!is_shared(root)) {
+            root->left = nullptr;
+            root->right = nullptr;
+            pool->destroy(root);
+        }
+        else {
+            // Разделённый корень остаётся другим копиям, его дети получают ссылку от этой
+            acquire(left);
+            acquire(right);
+            delete_tree(root);
+        }
+        root = merge_nodes(left, right);
+        node_count--;
     }
 
-    priority_queue& merge(const priority_queue& second) override {
-        const leftist_priority_queue* other_queue =
-            dynamic_cast<const leftist_priority_queue*>(&second);
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!root) throw "Queue is empty";
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+        T value = take_top_value();
+        delete_value();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка за O(n): одиночные узлы сливаются попарно кругами, как при
+    // построении снизу вверх, и результат один раз присоединяется к текущему дереву.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        std::vector<Node*> trees;
+        try {
+            for (; first != last; ++first) {
+                trees.push_back(pool->template create<Node>(make_value(first->first), first->second));
+            }
+        }
+        catch (...) {
+            attach_trees(trees);
+            throw;
+        }
+        attach_trees(trees);
+    }
+
+private:
+    void attach_trees(std::vector<Node*>& trees) {
+        node_count += static_cast<int>(trees.size());
+        while (trees.size() > 1) {
+            std::size_t joined = 0;
+            for (std::size_t i = 0; i + 1 < trees.size(); i += 2) {
+                trees[joined++] = merge_nodes(trees[i], trees[i + 1]);
+            }
+            if (trees.size() % 2 != 0) {
+                trees[joined++] = trees.back();
+            }
+            trees.resize(joined);
+        }
+        if (!trees.empty()) {
+            root = merge_nodes(root, trees[0]);
+        }
+    }
+
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    // Обход всех элементов в прямом порядке с явным стеком: visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const Node*> pending;
+        if (root) pending.push_back(root);
+
+        while (!pending.empty()) {
+            const Node* node = pending.back();
+            pending.pop_back();
+            visit(node->value, node->priority);
+
+            if (node->right) pending.push_back(node->right);
+            if (node->left) pending.push_back(node->left);
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && root; ++taken) {
+            consume(take_top_value(), root->priority);
+            delete_value();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Обход по фронту от корня: выданный узел добавляет во фронт обоих детей,
+    // поэтому стоимость O(count log count) и не зависит от размера очереди
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const Node* first, const Node* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const Node*> frontier;
+        if (count > 0 && root) {
+            frontier.reserve(std::min<std::size_t>(count, node_count) + 1);
+            frontier.push_back(root);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const Node* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            ++visited;
+
+            for (const Node* child : { node->left, node->right }) {
+                if (child) {
+                    frontier.push_back(child);
+                    std::push_heap(frontier.begin(), frontier.end(), lower);
+                }
+            }
         }
+        return visited;
+    }
 
-        Node* other_copy = copy_tree(other_queue->root);
+    basic_leftist_priority_queue& merge(const basic_leftist_priority_queue& other) {
+        Node* other_copy = share_tree(other);
         root = merge_nodes(root, other_copy);
+        node_count += other.node_count;
+
+        return *this;
+    }
+
+    // Слияние без копирования: узлы донора переходят в эту очередь, донор остаётся пустым
+    basic_leftist_priority_queue& merge(basic_leftist_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_leftist_priority_queue&>(other));
+            other = basic_leftist_priority_queue(*other.pool, other.compare);
+            return *this;
+        }
+
+        root = merge_nodes(root, other.root);
+        node_count += other.node_count;
+        other.root = nullptr;
+        other.node_count = 0;
 
         return *this;
     }
-    
+
     [[nodiscard]] bool is_empty() const {
         return root == nullptr;
     }
 
     [[nodiscard]] int get_size() const {
-        return count_nodes(root);
+        return node_count;
     }
 
-    [[nodiscard]] leftist_priority_queue meld(const leftist_priority_queue& other) {
-        leftist_priority_queue result;
+    [[nodiscard]] int size() const {
+        return node_count;
+    }
 
-        if (root && other.root) {
-            Node* copy1 = copy_tree(root);
-            Node* copy2 = copy_tree(other.root);
-            result.root = merge_nodes(copy1, copy2);
-        } else if (root) {
-            result.root = copy_tree(root);
-        } else if (other.root) {
-            result.root = copy_tree(other.root);
-        }
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
+    }
+
+    [[nodiscard]] basic_leftist_priority_queue meld(const basic_leftist_priority_queue& other) const {
+        basic_leftist_priority_queue result(*pool, compare);
+        result.root = merge_nodes(acquire(root), result.share_tree(other));
+        result.node_count = node_count + other.node_count;
 
         return result;
     }
 
 
-    friend void print_queue(const leftist_priority_queue& queue, const char* name) {
+    friend void print_queue(const basic_leftist_priority_queue& queue, const char* name) {
         std::cout << name << " (size: " << queue.get_size() << "):\n";
 
         if (queue.root) {
@@ -230,6 +478,105 @@ public:
     }
 };
 
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class leftist_priority_queue final : public basic_leftist_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_leftist_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        const leftist_priority_queue* other_queue =
+            dynamic_cast<const leftist_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        leftist_priority_queue* other_queue = dynamic_cast<leftist_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] leftist_priority_queue meld(const leftist_priority_queue& other) const {
+        leftist_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+// Значение с бросающей копией для проверки утечек при исключениях
+#include "throwing_copy_value.h"
+
 int main() {
     try {
         std::cout << "Basic operations\n";
@@ -313,7 +660,106 @@ int main() {
 
         priority_queue* interface_ptr = &queue1;
         const char* interface_max = interface_ptr->search_value(); // [[nodiscard]] из интерфейса
-        std::cout << "Max via interface: " << interface_max << "\n";
+        std::cout << "Max via interface: " << interface_max << "\n\n";
+
+        std::cout << "Generic queue (min-heap over 64-bit deadlines)\n";
+        std::cout << "----------------------------------\n";
+
+        {
+            basic_leftist_priority_queue<std::string, long long, std::greater<long long>> deadlines;
+            std::string report = "report";
+            deadlines.add_value(std::move(report), 5000000000LL);
+            deadlines.add_value(std::string("backup"), 3000000000LL);
+            deadlines.add_value(std::string("email"), 4000000000LL);
+
+            while (!deadlines.is_empty()) {
+                long long due = deadlines.search_priority();
+                std::string task = deadlines.extract_value();
+                std::cout << due << ": " << task << "\n";
+            }
+            std::cout << "\n";
+        }
+
+        std::cout << "Monotone insert regression\n";
+        std::cout << "----------------------------------\n";
+
+        // Возрастающие приоритеты (типичные метки времени) вытягивают дерево в цепочку
+        {
+            const int monotone_count = 10000000;
+            leftist_priority_queue monotone_queue;
+            for (int i = 0; i < monotone_count; ++i) {
+                monotone_queue.add_value("tick", i);
+            }
+            std::cout << "Inserted " << monotone_queue.get_size() << " increasing priorities\n";
+
+            for (int i = 0; i < 3; ++i) {
+                monotone_queue.delete_value();
+            }
+            std::cout << "Size after 3 pops: " << monotone_queue.get_size() << "\n";
+
+            leftist_priority_queue monotone_copy = monotone_queue;
+            std::cout << "Copy size: " << monotone_copy.get_size() << "\n";
+        }
+
+        std::cout << "\nNode pool\n";
+        std::cout << "----------------------------------\n";
+
+        // Отдельный пул: узлы и строки берутся из слябов, повторные строки не копируются
+        {
+            const int pool_ops = 1000000;
+            node_pool local_pool;
+            leftist_priority_queue pooled_queue(local_pool);
+            char label[16];
+
+            for (int i = 0; i < pool_ops; ++i) {
+                std::snprintf(label, sizeof(label), "job-%d", i % 1000);
+                pooled_queue.add_value(label, i);
+            }
+            std::size_t push_allocations = local_pool.system_allocations();
+            std::cout << "System allocations per push: "
+                << static_cast<double>(push_allocations) / pool_ops << "\n";
+            std::cout << "Interned strings: " << local_pool.interned_strings() << "\n";
+
+            while (!pooled_queue.is_empty()) {
+                pooled_queue.delete_value();
+            }
+            for (int i = 0; i < pool_ops; ++i) {
+                pooled_queue.add_value("job-0", i);
+            }
+            std::cout << "System allocations on refill: "
+                << local_pool.system_allocations() - push_allocations << "\n";
+
+            leftist_priority_queue other_queue(local_pool);
+            other_queue.add_value("job-1", -1);
+            pooled_queue.merge(std::move(other_queue));
+            std::cout << "Size after same-pool merge: " << pooled_queue.get_size() << "\n";
+        }
+
+        std::cout << "\nThrowing copy regression\n";
+        std::cout << "----------------------------------\n";
+
+        // Слияние с очередью другого пула копирует её узлы; прерванная копия освобождает скопированное
+        {
+            node_pool source_pool;
+            node_pool target_pool;
+            basic_leftist_priority_queue<throwing_copy_value> source(source_pool);
+            for (int i = 0; i < 100; ++i) {
+                source.add_value(throwing_copy_value(), i);
+            }
+            basic_leftist_priority_queue<throwing_copy_value> target(target_pool);
+            int live_before = throwing_copy_value::live;
+
+            throwing_copy_value::copies_left = 50;
+            try {
+                target.merge(source);
+            }
+            catch (const char* msg) {
+                std::cout << "Cross-pool merge: " << msg << "\n";
+            }
+
+            std::cout << "Values leaked by failed copies: " << throwing_copy_value::live - live_before << "\n";
+            std::cout << "Target size: " << target.get_size() << "\n";
+        }
 
     }
     catch (const char* msg) {
@@ -323,3 +769,4 @@ int main() {
 
     return 0;
 }
+#endif
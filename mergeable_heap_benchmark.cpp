@@ -0,0 +1,173 @@
+// Сравнение парной кучи с остальными реализациями на вставках/извлечениях, слияниях
+// и на decrease-key в алгоритме Дейкстры.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include "binary_priority_queue.cpp"
+#include "binomial_priority_queue.cpp"
+#include "fibonacci_priority_queue.cpp"
+#include "leftist_priority_queue.cpp"
+#include "skew_priority_queue.cpp"
+#include "treap_priority_queue.cpp"
+#include "pairing_priority_queue.cpp"
+
+// Каждый прогон получает свежий пул: иначе узлы следующей кучи выдаются из списков
+// свободных блоков, перемешанных предыдущей, и она проигрывает на промахах кэша
+template <typename Queue>
+Queue make_queue(node_pool& pool) {
+    if constexpr (std::is_constructible_v<Queue, node_pool&>) {
+        return Queue(pool);
+    }
+    else {
+        return Queue();
+    }
+}
+
+// count случайных вставок, затем полное опустошение; наносекунды на пару вставка + извлечение
+template <typename Queue>
+double push_pop_ns(int count, unsigned seed) {
+    std::mt19937 generator(seed);
+    node_pool pool;
+    Queue queue = make_queue<Queue>(pool);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        queue.add_value(i, static_cast<int>(generator() >> 1));
+    }
+    while (!queue.is_empty()) {
+        queue.delete_value();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / count;
+}
+
+// Турнир слияний: queue_count очередей по queue_size элементов сливаются попарно
+// перемещением, пока не останется одна; после каждого круга победители отдают вершину.
+// Наносекунды на одно слияние вместе с извлечением
+template <typename Queue>
+double meld_ns(int queue_count, int queue_size, unsigned seed) {
+    std::mt19937 generator(seed);
+    node_pool pool;
+    std::vector<Queue> queues;
+    queues.reserve(queue_count);
+    for (int q = 0; q < queue_count; ++q) {
+        queues.push_back(make_queue<Queue>(pool));
+    }
+    for (Queue& queue : queues) {
+        for (int i = 0; i < queue_size; ++i) {
+            queue.add_value(i, static_cast<int>(generator() >> 1));
+        }
+    }
+
+    long long melds = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 1; step < queue_count; step *= 2) {
+        for (int i = 0; i + step < queue_count; i += 2 * step) {
+            queues[i].merge(std::move(queues[i + step]));
+            queues[i].delete_value();
+            ++melds;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / melds;
+}
+
+// Дейкстра на куче с дескрипторами (фибоначчиева или парная): та же схема, что у
+// dijkstra_fibonacci, но очередь берёт свежий пул, а улучшения пути подсчитываются.
+// Возвращает миллисекунды; расстояния и число decrease-key кладутся в dist и decreases
+template <typename Queue>
+long long dijkstra_decrease_key_ms(const weighted_graph& graph, int source, std::vector<int>& dist, long long& decreases) {
+    node_pool pool;
+    Queue queue(pool);
+    std::vector<typename Queue::handle> handles(graph.vertex_count);
+    std::vector<bool> done(graph.vertex_count, false);
+    dist.assign(graph.vertex_count, INT_MAX);
+    decreases = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    dist[source] = 0;
+    handles[source] = queue.insert_value(source, 0);
+
+    while (!queue.is_empty()) {
+        int v = queue.extract_value();
+        handles[v] = typename Queue::handle();
+        done[v] = true;
+
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            int candidate = dist[v] + graph.weights[e];
+            if (done[u] || candidate >= dist[u]) continue;
+
+            dist[u] = candidate;
+            if (handles[u].is_valid()) {
+                queue.increase_priority(handles[u], candidate);
+                ++decreases;
+            }
+            else {
+                handles[u] = queue.insert_value(u, candidate);
+            }
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Report>
+void for_each_heap(Report report) {
+    report("binary", [](auto run) { return run(static_cast<basic_binary_priority_queue<int>*>(nullptr)); });
+    report("binomial", [](auto run) { return run(static_cast<basic_binomial_priority_queue<int>*>(nullptr)); });
+    report("fibonacci", [](auto run) { return run(static_cast<basic_fibonacci_priority_queue<int>*>(nullptr)); });
+    report("leftist", [](auto run) { return run(static_cast<basic_leftist_priority_queue<int>*>(nullptr)); });
+    report("skew", [](auto run) { return run(static_cast<basic_skew_priority_queue<int>*>(nullptr)); });
+    report("treap", [](auto run) { return run(static_cast<basic_treap_priority_queue<int>*>(nullptr)); });
+    report("pairing", [](auto run) { return run(static_cast<basic_pairing_priority_queue<int>*>(nullptr)); });
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+        std::cout << "Push then drain, " << count << " elements (ns per push + pop)\n";
+        std::cout << "-----------------------------------------------------\n";
+        for_each_heap([count](const char* name, auto with_heap) {
+            double time = with_heap([count](auto* tag) {
+                return push_pop_ns<std::remove_pointer_t<decltype(tag)>>(count, 1);
+            });
+            std::cout << "  " << name << ": " << time << "\n";
+        });
+
+        std::cout << "\nMeld tournament, 16384 queues x 64 elements (ns per meld + pop)\n";
+        std::cout << "----------------------------------------------------------------\n";
+        for_each_heap([](const char* name, auto with_heap) {
+            double time = with_heap([](auto* tag) {
+                return meld_ns<std::remove_pointer_t<decltype(tag)>>(16384, 64, 2);
+            });
+            std::cout << "  " << name << ": " << time << "\n";
+        });
+
+        // Кучи с дескрипторами на decrease-key: фибоначчиева даёт O(1) амортизированно,
+        // парная - o(log n), но с меньшими узлами и без каскадных вырезаний
+        std::cout << "\nDijkstra with decrease-key, 10 edges per vertex, weights 1..100 (ms)\n";
+        std::cout << "--------------------------------------------------------------------\n";
+        for (int vertices = 100000; vertices <= count; vertices *= 10) {
+            weighted_graph graph = make_random_graph(vertices, 10, 2024);
+            std::vector<int> reference = dijkstra_lazy_binary(graph, 0);
+
+            std::vector<int> fib_dist, pairing_dist;
+            long long fib_decreases = 0, pairing_decreases = 0;
+            long long fib_time = dijkstra_decrease_key_ms<basic_fibonacci_priority_queue<int, int, std::greater<int>>>(
+                graph, 0, fib_dist, fib_decreases);
+            long long pairing_time = dijkstra_decrease_key_ms<basic_pairing_priority_queue<int, int, std::greater<int>>>(
+                graph, 0, pairing_dist, pairing_decreases);
+
+            std::cout << "  vertices = " << vertices << ": fibonacci " << fib_time << ", pairing " << pairing_time
+                      << ", decrease-key calls " << fib_decreases << " / " << pairing_decreases
+                      << ", distances match: " << (fib_dist == reference && pairing_dist == reference ? "true" : "false")
+                      << "\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
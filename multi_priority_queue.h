@@ -0,0 +1,185 @@
+#ifndef MULTI_PRIORITY_QUEUE_H
+#define MULTI_PRIORITY_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "node_pool.h"
+
+// Конкурентная очередь с ослабленным порядком (MultiQueue): набор независимых куч-шардов,
+// каждая под своим мьютексом. Вставка идёт в случайный шард, извлечение берёт лучшую
+// из вершин двух случайных шардов, поэтому извлекается не обязательно глобальный
+// максимум, а элемент с небольшой ошибкой ранга (в среднем порядка числа шардов).
+// Heap - любая из обобщённых куч: basic_binary_priority_queue, basic_leftist_priority_queue и т.д.
+// Кучи с узлами в пуле получают по собственному пулу на шард: такой пул не синхронизирован
+// и трогается только под мьютексом шарда, поэтому в нём живут лишь узлы. Значение T
+// извлекший поток разрушает уже без блокировки, так что pooled_string в T допустим только
+// из общего пула процесса, а не из явно созданного node_pool
+template <template <typename, typename, typename> class Heap,
+          typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_multi_priority_queue {
+    static_assert(std::is_trivially_copyable_v<Priority>, "shard tops are published atomically");
+
+    using heap_type = Heap<T, Priority, Compare>;
+
+    // Сколько раз пробовать случайные шарды через try_lock до перехода к блокирующему пути
+    static constexpr int TRY_LOCK_ATTEMPTS = 16;
+
+    static heap_type make_heap(node_pool& pool, const Compare& order) {
+        if constexpr (std::is_constructible_v<heap_type, node_pool&, const Compare&>) {
+            return heap_type(pool, order);
+        }
+        else {
+            return heap_type(order);
+        }
+    }
+
+    // Шарды лежат на отдельных кэш-линиях, чтобы их блокировки не мешали друг другу
+    struct alignas(64) shard {
+        std::mutex lock;
+        node_pool pool;
+        heap_type heap;
+
+        // Копии вершины и размера: по ним выбирают шард, не захватывая его мьютекс
+        std::atomic<Priority> top;
+        std::atomic<int> count;
+
+        explicit shard(const Compare& order)
+            : heap(make_heap(pool, order)),
+              top(Priority()),
+              count(0) {
+        }
+
+        // Вызывается под мьютексом шарда после каждого изменения кучи
+        void publish() {
+            int size = heap.size();
+            if (size > 0) {
+                top.store(heap.search_priority(), std::memory_order_relaxed);
+            }
+            count.store(size, std::memory_order_release);
+        }
+    };
+
+    std::vector<std::unique_ptr<shard>> shards;
+    Compare compare;
+
+    // xorshift на поток: std::mt19937 под каждой операцией заметно дороже самой вставки
+    static std::uint64_t next_random() {
+        thread_local std::uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    [[nodiscard]] shard& random_shard() const {
+        std::uint64_t index = ((next_random() >> 32) * shards.size()) >> 32;
+        return *shards[index];
+    }
+
+    // Лучший из двух шардов по опубликованным вершинам; nullptr, если оба пусты
+    [[nodiscard]] shard* better_of(shard& first, shard& second) const {
+        bool first_empty = first.count.load(std::memory_order_acquire) == 0;
+        bool second_empty = second.count.load(std::memory_order_acquire) == 0;
+        if (first_empty) return second_empty ? nullptr : &second;
+        if (second_empty) return &first;
+
+        Priority first_top = first.top.load(std::memory_order_relaxed);
+        Priority second_top = second.top.load(std::memory_order_relaxed);
+        return compare(first_top, second_top) ? &second : &first;
+    }
+
+    static void extract_from(shard& source, T& value, Priority& priority) {
+        priority = source.heap.search_priority();
+        value = source.heap.extract_value();
+        source.publish();
+    }
+
+public:
+    explicit basic_multi_priority_queue(int shard_count, const Compare& order = Compare())
+        : compare(order) {
+        if (shard_count <= 0) {
+            throw "Invalid shard count: must be positive";
+        }
+
+        shards.reserve(shard_count);
+        for (int i = 0; i < shard_count; ++i) {
+            shards.push_back(std::make_unique<shard>(order));
+        }
+    }
+
+    basic_multi_priority_queue(const basic_multi_priority_queue&) = delete;
+    basic_multi_priority_queue& operator=(const basic_multi_priority_queue&) = delete;
+
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        for (int attempt = 0; attempt < TRY_LOCK_ATTEMPTS; ++attempt) {
+            shard& target = random_shard();
+            std::unique_lock<std::mutex> guard(target.lock, std::try_to_lock);
+            if (guard.owns_lock()) {
+                target.heap.add_value(std::forward<Value>(value), priority);
+                target.publish();
+                return;
+            }
+        }
+
+        shard& target = random_shard();
+        std::lock_guard<std::mutex> guard(target.lock);
+        target.heap.add_value(std::forward<Value>(value), priority);
+        target.publish();
+    }
+
+    // Извлекает вершину лучшего из двух случайных шардов. false - все шарды
+    // оказались пусты при последовательной проверке под их мьютексами
+    bool try_extract(T& value, Priority& priority) {
+        for (int attempt = 0; attempt < TRY_LOCK_ATTEMPTS; ++attempt) {
+            shard* source = better_of(random_shard(), random_shard());
+            if (!source) continue;
+
+            std::unique_lock<std::mutex> guard(source->lock, std::try_to_lock);
+            if (!guard.owns_lock() || source->heap.is_empty()) continue;
+
+            extract_from(*source, value, priority);
+            return true;
+        }
+
+        for (auto& candidate : shards) {
+            std::lock_guard<std::mutex> guard(candidate->lock);
+            if (!candidate->heap.is_empty()) {
+                extract_from(*candidate, value, priority);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool try_extract(T& value) {
+        Priority priority;
+        return try_extract(value, priority);
+    }
+
+    // Сумма опубликованных размеров: при параллельных изменениях значение приблизительное
+    [[nodiscard]] int size() const {
+        int total = 0;
+        for (const auto& candidate : shards) {
+            total += candidate->count.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    [[nodiscard]] bool is_empty() const {
+        return size() == 0;
+    }
+
+    [[nodiscard]] int shard_count() const {
+        return static_cast<int>(shards.size());
+    }
+};
+
+#endif //MULTI_PRIORITY_QUEUE_H
@@ -0,0 +1,368 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Пул памяти для узлов очередей с приоритетом и их строк.
+// Мелкие блоки нарезаются из крупных слябов и после освобождения уходят
+// в список свободных блоков своего размера; строки хранятся в том же пуле
+// один раз и разделяются по счётчику ссылок.
+// Созданный явно пул однопоточный и должен пережить все очереди, которые им пользуются.
+// Общий пул процесса (process_default) не разрушается и защищён мьютексом.
+class node_pool final {
+    static constexpr std::size_t GRANULARITY = 16;
+    static constexpr std::size_t MAX_BLOCK_SIZE = 256;
+    static constexpr std::size_t CLASS_COUNT = MAX_BLOCK_SIZE / GRANULARITY;
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    // Заголовок строки лежит прямо перед её символами
+    struct string_header {
+        node_pool* owner;
+        int references;
+        int length;
+    };
+
+    static_assert(sizeof(string_header) % GRANULARITY == 0, "string data must stay aligned");
+
+    free_block* free_lists[CLASS_COUNT];
+    std::vector<void*> slabs;
+    char* slab_cursor;
+    std::size_t slab_left;
+
+    // Таблица строк с открытой адресацией: nullptr - пусто, TOMBSTONE - удалено
+    std::vector<const char*> strings;
+    std::size_t strings_used;
+    std::size_t strings_live;
+
+    std::size_t system_allocation_count;
+
+    // Только у общего пула процесса: им могут пользоваться очереди разных потоков
+    const bool synchronized;
+    mutable std::mutex guard;
+
+    explicit node_pool(bool synchronized_access)
+        : free_lists{},
+          slab_cursor(nullptr),
+          slab_left(0),
+          strings(16, nullptr),
+          strings_used(0),
+          strings_live(0),
+          system_allocation_count(0),
+          synchronized(synchronized_access) {
+    }
+
+    [[nodiscard]] std::unique_lock<std::mutex> lock() const {
+        return synchronized ? std::unique_lock<std::mutex>(guard) : std::unique_lock<std::mutex>();
+    }
+
+    static const char* tombstone() {
+        return reinterpret_cast<const char*>(static_cast<std::uintptr_t>(1));
+    }
+
+    static std::size_t size_class(std::size_t bytes) {
+        return (bytes + GRANULARITY - 1) / GRANULARITY - 1;
+    }
+
+    static string_header* header_of(const char* str) {
+        return reinterpret_cast<string_header*>(const_cast<char*>(str) - sizeof(string_header));
+    }
+
+    static std::size_t hash_of(const char* str, std::size_t length) {
+        std::size_t hash = 14695981039346656037ull;
+        for (std::size_t i = 0; i < length; ++i) {
+            hash ^= static_cast<unsigned char>(str[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void* system_allocate(std::size_t bytes) {
+        ++system_allocation_count;
+        return ::operator new(bytes);
+    }
+
+    void* carve(std::size_t block_size) {
+        if (slab_left < block_size) {
+            slab_cursor = static_cast<char*>(system_allocate(SLAB_SIZE));
+            slab_left = SLAB_SIZE;
+            slabs.push_back(slab_cursor);
+        }
+
+        void* block = slab_cursor;
+        slab_cursor += block_size;
+        slab_left -= block_size;
+        return block;
+    }
+
+    void rehash(std::size_t new_capacity) {
+        std::vector<const char*> old_strings(new_capacity, nullptr);
+        old_strings.swap(strings);
+        strings_used = strings_live;
+
+        for (const char* str : old_strings) {
+            if (!str || str == tombstone()) continue;
+
+            std::size_t mask = strings.size() - 1;
+            std::size_t slot = hash_of(str, header_of(str)->length) & mask;
+            while (strings[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            strings[slot] = str;
+        }
+    }
+
+    void erase_string(const char* str) {
+        string_header* header = header_of(str);
+        std::size_t mask = strings.size() - 1;
+        std::size_t slot = hash_of(str, header->length) & mask;
+        while (strings[slot] != str) {
+            slot = (slot + 1) & mask;
+        }
+        strings[slot] = tombstone();
+        --strings_live;
+
+        release_block(header, sizeof(string_header) + header->length + 1);
+    }
+
+    // allocate и deallocate без блокировки: вызываются под уже взятым lock()
+    void* take_block(std::size_t bytes) {
+        if (bytes > MAX_BLOCK_SIZE) {
+            return system_allocate(bytes);
+        }
+
+        std::size_t index = size_class(bytes);
+        if (free_block* block = free_lists[index]) {
+            free_lists[index] = block->next;
+            return block;
+        }
+        return carve((index + 1) * GRANULARITY);
+    }
+
+    void release_block(void* ptr, std::size_t bytes) {
+        if (!ptr) return;
+        if (bytes > MAX_BLOCK_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        std::size_t index = size_class(bytes);
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next = free_lists[index];
+        free_lists[index] = block;
+    }
+
+public:
+    node_pool() : node_pool(false) {}
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    ~node_pool() {
+        for (void* slab : slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    // Общий пул процесса: им пользуются очереди, созданные без явного пула.
+    // Создаётся при первом обращении и не разрушается до выхода из процесса, так что
+    // узлы и строки не зависят от того, какой поток их добавил и жив ли он ещё
+    static node_pool& process_default() {
+        static node_pool* const pool = new node_pool(true);
+        return *pool;
+    }
+
+    void* allocate(std::size_t bytes) {
+        auto held = lock();
+        return take_block(bytes);
+    }
+
+    void deallocate(void* ptr, std::size_t bytes) {
+        auto held = lock();
+        release_block(ptr, bytes);
+    }
+
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) {
+        void* memory = allocate(sizeof(Node));
+        try {
+            return new (memory) Node(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            deallocate(memory, sizeof(Node));
+            throw;
+        }
+    }
+
+    template <typename Node>
+    void destroy(Node* node) {
+        if (!node) return;
+        node->~Node();
+        deallocate(node, sizeof(Node));
+    }
+
+    // Пакетное освобождение при разрушении целой кучи: блоки разрушенных узлов
+    // сцепляются между собой и уходят в список свободных одним присоединением
+    template <typename Node>
+    class teardown final {
+        node_pool& pool;
+        free_block* first;
+        free_block* last;
+
+    public:
+        explicit teardown(node_pool& owner) : pool(owner), first(nullptr), last(nullptr) {}
+
+        teardown(const teardown&) = delete;
+        teardown& operator=(const teardown&) = delete;
+
+        ~teardown() {
+            flush();
+        }
+
+        void destroy(Node* node) {
+            node->~Node();
+            if (sizeof(Node) > MAX_BLOCK_SIZE) {
+                pool.deallocate(node, sizeof(Node));
+                return;
+            }
+
+            free_block* block = static_cast<free_block*>(static_cast<void*>(node));
+            block->next = first;
+            if (!last) last = block;
+            first = block;
+        }
+
+        void flush() {
+            if (!first) return;
+            auto held = pool.lock();
+            std::size_t index = size_class(sizeof(Node));
+            last->next = pool.free_lists[index];
+            pool.free_lists[index] = first;
+            first = nullptr;
+            last = nullptr;
+        }
+    };
+
+    // Возвращает разделяемую копию строки: одинаковые строки хранятся один раз
+    const char* intern(const char* str) {
+        std::size_t length = std::strlen(str);
+        auto held = lock();
+
+        if ((strings_used + 1) * 4 > strings.size() * 3) {
+            rehash(strings_live * 2 + 2 > strings.size() / 2 ? strings.size() * 2 : strings.size());
+        }
+
+        std::size_t mask = strings.size() - 1;
+        std::size_t slot = hash_of(str, length) & mask;
+        std::size_t free_slot = strings.size();
+
+        while (strings[slot]) {
+            const char* candidate = strings[slot];
+            if (candidate == tombstone()) {
+                if (free_slot == strings.size()) free_slot = slot;
+            }
+            else if (static_cast<std::size_t>(header_of(candidate)->length) == length &&
+                     std::memcmp(candidate, str, length) == 0) {
+                ++header_of(candidate)->references;
+                return candidate;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        if (free_slot == strings.size()) {
+            free_slot = slot;
+            ++strings_used;
+        }
+
+        string_header* header = static_cast<string_header*>(take_block(sizeof(string_header) + length + 1));
+        header->owner = this;
+        header->references = 1;
+        header->length = static_cast<int>(length);
+
+        char* data = reinterpret_cast<char*>(header + 1);
+        std::memcpy(data, str, length + 1);
+
+        strings[free_slot] = data;
+        ++strings_live;
+        return data;
+    }
+
+    static const char* share(const char* str) {
+        string_header* header = header_of(str);
+        auto held = header->owner->lock();
+        ++header->references;
+        return str;
+    }
+
+    static void release(const char* str) {
+        if (!str) return;
+        string_header* header = header_of(str);
+        auto held = header->owner->lock();
+        if (--header->references == 0) {
+            header->owner->erase_string(str);
+        }
+    }
+
+    [[nodiscard]] std::size_t system_allocations() const {
+        auto held = lock();
+        return system_allocation_count;
+    }
+
+    [[nodiscard]] std::size_t slab_count() const {
+        auto held = lock();
+        return slabs.size();
+    }
+
+    [[nodiscard]] std::size_t interned_strings() const {
+        auto held = lock();
+        return strings_live;
+    }
+};
+
+// Владеющая ссылка на интернированную строку: копия разделяет строку,
+// разрушение уменьшает счётчик. Строка должна не пережить свой пул
+class pooled_string final {
+    const char* data;
+
+public:
+    pooled_string() noexcept : data(nullptr) {}
+
+    // Принимает строку, уже полученную из node_pool::intern
+    explicit pooled_string(const char* interned) noexcept : data(interned) {}
+
+    pooled_string(const pooled_string& other) noexcept
+        : data(other.data ? node_pool::share(other.data) : nullptr) {}
+
+    pooled_string(pooled_string&& other) noexcept : data(other.data) {
+        other.data = nullptr;
+    }
+
+    pooled_string& operator=(pooled_string other) noexcept {
+        std::swap(data, other.data);
+        return *this;
+    }
+
+    ~pooled_string() {
+        node_pool::release(data);
+    }
+
+    [[nodiscard]] const char* c_str() const noexcept {
+        return data;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const pooled_string& str) {
+        return os << (str.data ? str.data : "null");
+    }
+};
+
+#endif //NODE_POOL_H
@@ -0,0 +1,79 @@
+// Число системных выделений памяти на операцию у каждой реализации с пулом узлов.
+// До пула каждая вставка делала два new (узел и копия строки), каждое извлечение - два delete.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <cstdio>
+#include <cstdlib>
+#include "binary_priority_queue.cpp"
+#include "binomial_priority_queue.cpp"
+#include "fibonacci_priority_queue.cpp"
+#include "leftist_priority_queue.cpp"
+#include "skew_priority_queue.cpp"
+#include "treap_priority_queue.cpp"
+#include "allocation_counter.h"
+
+// Очереди с узлами в пуле получают свежий пул, двоичная куча интернирует строки в общий пул процесса
+template <typename Queue>
+Queue make_queue(node_pool& pool) {
+    if constexpr (std::is_constructible_v<Queue, node_pool&>) {
+        return Queue(pool);
+    }
+    else {
+        return Queue();
+    }
+}
+
+// count вставок с 1000 различными строками, полное опустошение и повторное заполнение
+// тем же пулом. Печатает выделения на вставку в пустой пул, на извлечение и на вставку
+// в пул, уже заполненный освобождёнными блоками
+template <typename Queue>
+void report_allocations(const char* name, int count) {
+    node_pool pool;
+    Queue queue = make_queue<Queue>(pool);
+    char label[16];
+
+    long long start = allocation_count;
+    for (int i = 0; i < count; ++i) {
+        std::snprintf(label, sizeof(label), "job-%d", i % 1000);
+        queue.add_value(label, i);
+    }
+    long long pushes = allocation_count - start;
+
+    start = allocation_count;
+    while (!queue.is_empty()) {
+        queue.delete_value();
+    }
+    long long pops = allocation_count - start;
+
+    start = allocation_count;
+    for (int i = 0; i < count; ++i) {
+        std::snprintf(label, sizeof(label), "job-%d", i % 1000);
+        queue.add_value(label, i);
+    }
+    long long refills = allocation_count - start;
+
+    std::cout << "  " << name << ": push " << static_cast<double>(pushes) / count
+              << ", pop " << static_cast<double>(pops) / count
+              << ", refill " << static_cast<double>(refills) / count << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+        std::cout << "System allocations per operation, " << count << " elements (before the pool: push 2, pop 0)\n";
+        std::cout << "--------------------------------------------------------------------\n";
+        report_allocations<binary_priority_queue>("binary", count);
+        report_allocations<binomial_priority_queue>("binomial", count);
+        report_allocations<fibonacci_priority_queue>("fibonacci", count);
+        report_allocations<leftist_priority_queue>("leftist", count);
+        report_allocations<skew_priority_queue>("skew", count);
+        report_allocations<treap_priority_queue>("treap", count);
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,648 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+#include "5z.h"
+#include "node_pool.h"
+
+// Парная куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Вставка и слияние - O(1) одним связыванием,
+// извлечение - двухпроходное попарное слияние детей корня за O(log n) амортизированно
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_pairing_priority_queue {
+    // Узел хранит только три указателя: первый ребёнок, следующий брат
+    // и prev - предыдущий брат или, у первого ребёнка, родитель
+    struct PairingNode {
+        T value;
+        Priority priority;
+        PairingNode* child;
+        PairingNode* sibling;
+        PairingNode* prev;
+
+        template <typename Value>
+        PairingNode(Value&& v, const Priority& p)
+            : value(std::forward<Value>(v)), priority(p), child(nullptr), sibling(nullptr), prev(nullptr) {}
+
+        PairingNode(const PairingNode&) = delete;
+        PairingNode& operator=(const PairingNode&) = delete;
+    };
+
+    PairingNode* root;
+    int node_count;
+    node_pool* pool;
+    Compare compare;
+
+    // Связывает два корня: худший становится первым ребёнком лучшего
+    PairingNode* link(PairingNode* first, PairingNode* second) {
+        if (!first) return second;
+        if (!second) return first;
+
+        if (compare(first->priority, second->priority)) {
+            std::swap(first, second);
+        }
+
+        second->sibling = first->child;
+        if (first->child) first->child->prev = second;
+        second->prev = first;
+        first->child = second;
+        first->sibling = nullptr;
+        first->prev = nullptr;
+        return first;
+    }
+
+    // Двухпроходное слияние списка братьев: слева направо попарно,
+    // затем справа налево в одно дерево. Результаты первого прохода складываются
+    // в стек через sibling победителей, так что извлечение не выделяет память
+    PairingNode* combine_siblings(PairingNode* first) {
+        if (!first) return nullptr;
+
+        PairingNode* pairs = nullptr;
+        while (first) {
+            PairingNode* second = first->sibling;
+            PairingNode* next = second ? second->sibling : nullptr;
+            PairingNode* pair = link(first, second);
+            pair->sibling = pairs;
+            pairs = pair;
+            first = next;
+        }
+
+        PairingNode* result = pairs;
+        pairs = pairs->sibling;
+        while (pairs) {
+            PairingNode* next = pairs->sibling;
+            result = link(pairs, result);
+            pairs = next;
+        }
+        result->sibling = nullptr;
+        result->prev = nullptr;
+        return result;
+    }
+
+    // Вырезает поддерево узла из списка детей его родителя
+    void detach(PairingNode* node) {
+        if (node->prev->child == node) {
+            node->prev->child = node->sibling;
+        }
+        else {
+            node->prev->sibling = node->sibling;
+        }
+        if (node->sibling) node->sibling->prev = node->prev;
+
+        node->sibling = nullptr;
+        node->prev = nullptr;
+    }
+
+    // Обход с явным стеком: после множества вставок у корня длинный список
+    // детей, и рекурсия по братьям переполнила бы стек
+    void delete_tree(PairingNode* node) {
+        if (!node) return;
+
+        std::vector<PairingNode*> stack{ node };
+        while (!stack.empty()) {
+            PairingNode* current = stack.back();
+            stack.pop_back();
+
+            if (current->child) stack.push_back(current->child);
+            if (current->sibling) stack.push_back(current->sibling);
+            pool->destroy(current);
+        }
+    }
+
+    PairingNode* copy_tree(const PairingNode* source) {
+        if (!source) return nullptr;
+
+        PairingNode* copy_root = pool->template create<PairingNode>(source->value, source->priority);
+        try {
+            std::vector<std::pair<const PairingNode*, PairingNode*>> stack{ { source, copy_root } };
+            while (!stack.empty()) {
+                auto [from, to] = stack.back();
+                stack.pop_back();
+
+                PairingNode* last = nullptr;
+                for (const PairingNode* child = from->child; child; child = child->sibling) {
+                    PairingNode* copy = pool->template create<PairingNode>(child->value, child->priority);
+                    if (last) {
+                        last->sibling = copy;
+                        copy->prev = last;
+                    }
+                    else {
+                        to->child = copy;
+                        copy->prev = to;
+                    }
+                    last = copy;
+
+                    if (child->child) stack.emplace_back(child, copy);
+                }
+            }
+        }
+        catch (...) {
+            delete_tree(copy_root);
+            throw;
+        }
+        return copy_root;
+    }
+
+public:
+    basic_pairing_priority_queue() : basic_pairing_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_pairing_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : root(nullptr), node_count(0), pool(&shared_pool), compare(order) {}
+
+    basic_pairing_priority_queue(const basic_pairing_priority_queue& other)
+        : root(nullptr), node_count(0), pool(other.pool), compare(other.compare) {
+        root = copy_tree(other.root);
+        node_count = other.node_count;
+    }
+
+    basic_pairing_priority_queue& operator=(const basic_pairing_priority_queue& other) {
+        if (this != &other) {
+            PairingNode* new_root = copy_tree(other.root);
+            delete_tree(root);
+            root = new_root;
+            node_count = other.node_count;
+            compare = other.compare;
+        }
+        return *this;
+    }
+
+    basic_pairing_priority_queue(basic_pairing_priority_queue&& other) noexcept
+        : root(other.root), node_count(other.node_count), pool(other.pool), compare(other.compare) {
+        other.root = nullptr;
+        other.node_count = 0;
+    }
+
+    basic_pairing_priority_queue& operator=(basic_pairing_priority_queue&& other) noexcept {
+        if (this != &other) {
+            delete_tree(root);
+            root = other.root;
+            node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
+            other.root = nullptr;
+            other.node_count = 0;
+        }
+        return *this;
+    }
+
+    ~basic_pairing_priority_queue() {
+        delete_tree(root);
+    }
+
+    // Дескриптор элемента: узлы не перемещаются, поэтому он остаётся действительным,
+    // пока элемент не удалён из очереди (delete_value/erase). Копии очереди его не разделяют
+    class handle {
+        PairingNode* node;
+        explicit handle(PairingNode* n) : node(n) {}
+        friend class basic_pairing_priority_queue;
+    public:
+        handle() : node(nullptr) {}
+
+        [[nodiscard]] bool is_valid() const {
+            return node != nullptr;
+        }
+
+        [[nodiscard]] const Priority& priority() const {
+            if (!node) throw "Invalid handle";
+            return node->priority;
+        }
+
+        [[nodiscard]] const T& value() const {
+            if (!node) throw "Invalid handle";
+            return node->value;
+        }
+    };
+
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        insert_value(std::forward<Value>(value), priority);
+    }
+
+    template <typename Value>
+    handle insert_value(Value&& value, const Priority& priority) {
+        PairingNode* new_node = pool->template create<PairingNode>(std::forward<Value>(value), priority);
+        root = link(root, new_node);
+        node_count++;
+        return handle(new_node);
+    }
+
+    // Продвижение элемента к вершине за O(1): поддерево вырезается и связывается с корнем.
+    // Для std::greater это decrease-key
+    void increase_priority(handle element, const Priority& new_priority) {
+        PairingNode* node = element.node;
+        if (!node) throw "Invalid handle";
+        if (compare(new_priority, node->priority)) throw "New priority is lower than current";
+
+        node->priority = new_priority;
+        if (node != root) {
+            detach(node);
+            root = link(root, node);
+        }
+    }
+
+    // Удаление произвольного элемента: его поддерево вырезается, дети
+    // сливаются в одно дерево и связываются с корнем
+    void erase(handle element) {
+        PairingNode* node = element.node;
+        if (!node) throw "Invalid handle";
+
+        if (node == root) {
+            delete_value();
+            return;
+        }
+
+        detach(node);
+        root = link(root, combine_siblings(node->child));
+        node_count--;
+        pool->destroy(node);
+    }
+
+    [[nodiscard]] const T& search_value() const {
+        if (!root) throw "Queue is empty";
+        return root->value;
+    }
+
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!root) throw "Queue is empty";
+        return root->priority;
+    }
+
+    void delete_value() {
+        if (!root) throw "Queue is empty";
+
+        PairingNode* old_root = root;
+        root = combine_siblings(old_root->child);
+        node_count--;
+        pool->destroy(old_root);
+    }
+
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!root) throw "Queue is empty";
+
+        T value = std::move(root->value);
+        delete_value();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка за O(n): одиночные узлы связываются попарно кругами, как при
+    // построении снизу вверх, и результат один раз присоединяется к текущему дереву.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        std::vector<PairingNode*> trees;
+        try {
+            for (; first != last; ++first) {
+                trees.push_back(pool->template create<PairingNode>(make_value(first->first), first->second));
+            }
+        }
+        catch (...) {
+            attach_trees(trees);
+            throw;
+        }
+        attach_trees(trees);
+    }
+
+private:
+    void attach_trees(std::vector<PairingNode*>& trees) {
+        node_count += static_cast<int>(trees.size());
+        while (trees.size() > 1) {
+            std::size_t joined = 0;
+            for (std::size_t i = 0; i + 1 < trees.size(); i += 2) {
+                trees[joined++] = link(trees[i], trees[i + 1]);
+            }
+            if (trees.size() % 2 != 0) {
+                trees[joined++] = trees.back();
+            }
+            trees.resize(joined);
+        }
+        if (!trees.empty()) {
+            root = link(root, trees[0]);
+        }
+    }
+
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    // Обход всех элементов в прямом порядке с явным стеком: visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const PairingNode*> pending;
+        if (root) pending.push_back(root);
+
+        while (!pending.empty()) {
+            const PairingNode* node = pending.back();
+            pending.pop_back();
+            visit(node->value, node->priority);
+
+            if (node->sibling) pending.push_back(node->sibling);
+            if (node->child) pending.push_back(node->child);
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && root; ++taken) {
+            consume(std::move(root->value), root->priority);
+            delete_value();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Обход по фронту от корня: выданный узел добавляет во фронт весь список своих детей,
+    // кроме последнего выданного - его дети уже не понадобятся
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const PairingNode* first, const PairingNode* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const PairingNode*> frontier;
+        if (count > 0 && root) {
+            frontier.push_back(root);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const PairingNode* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            if (++visited == count) break;
+
+            // Длинный список детей (у корня после n вставок их n - 1) дешевле дописать
+            // целиком и перестроить фронт одним make_heap, короткий - просеять поштучно
+            std::size_t heap_size = frontier.size();
+            for (const PairingNode* child = node->child; child; child = child->sibling) {
+                frontier.push_back(child);
+            }
+            if (frontier.size() - heap_size > heap_size) {
+                std::make_heap(frontier.begin(), frontier.end(), lower);
+            }
+            else {
+                for (std::size_t i = heap_size + 1; i <= frontier.size(); ++i) {
+                    std::push_heap(frontier.begin(), frontier.begin() + i, lower);
+                }
+            }
+        }
+        return visited;
+    }
+
+    basic_pairing_priority_queue& merge(const basic_pairing_priority_queue& other) {
+        // Узлы донора копируются в свой пул: иначе обе очереди владели бы одними узлами
+        basic_pairing_priority_queue donor(*pool, compare);
+        donor = other;
+        return merge(std::move(donor));
+    }
+
+    // Слияние за O(1) одним связыванием корней; донор остаётся пустым
+    basic_pairing_priority_queue& merge(basic_pairing_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_pairing_priority_queue&>(other));
+            other = basic_pairing_priority_queue(*other.pool, other.compare);
+            return *this;
+        }
+
+        root = link(root, other.root);
+        node_count += other.node_count;
+        other.root = nullptr;
+        other.node_count = 0;
+        return *this;
+    }
+
+    [[nodiscard]] bool is_empty() const {
+        return root == nullptr;
+    }
+
+    [[nodiscard]] int get_size() const {
+        return node_count;
+    }
+
+    [[nodiscard]] int size() const {
+        return node_count;
+    }
+
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
+    }
+
+    [[nodiscard]] basic_pairing_priority_queue meld(const basic_pairing_priority_queue& other) const {
+        basic_pairing_priority_queue result = *this;
+        result.merge(other);
+        return result;
+    }
+
+    friend void print_queue(const basic_pairing_priority_queue& queue, const char* name) {
+        std::cout << name << " (size: " << queue.get_size() << "):\n";
+
+        if (!queue.root) {
+            std::cout << "  [EMPTY]\n\n";
+            return;
+        }
+
+        std::vector<std::pair<const PairingNode*, int>> stack{ { queue.root, 1 } };
+        while (!stack.empty()) {
+            auto [node, depth] = stack.back();
+            stack.pop_back();
+
+            for (int i = 0; i < depth; ++i) std::cout << "  ";
+            std::cout << "[Prio: " << node->priority << ", Val: " << node->value << "]\n";
+
+            if (node->sibling) stack.emplace_back(node->sibling, depth);
+            if (node->child) stack.emplace_back(node->child, depth + 1);
+        }
+        std::cout << "\n";
+    }
+};
+
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class pairing_priority_queue final : public basic_pairing_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_pairing_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        insert_value(str, priority);
+    }
+
+    handle insert_value(const char* str, int priority) {
+        return base::insert_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        auto other_queue = dynamic_cast<const pairing_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        auto other_queue = dynamic_cast<pairing_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] pairing_priority_queue meld(const pairing_priority_queue& other) const {
+        pairing_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+int main() {
+    try {
+        std::cout << "Pairing Queue Basic Operations\n";
+        std::cout << "------------------------------\n";
+
+        pairing_priority_queue queue;
+        queue.add_value("Task X", 15);
+        queue.add_value("Task Y", 35);
+        queue.add_value("Task Z", 25);
+        queue.add_value("Task W", 45);
+
+        print_queue(queue, "Pairing Queue after adding 4 tasks");
+        std::cout << "Max priority: " << queue.search_value() << "\n\n";
+
+        queue.delete_value();
+        print_queue(queue, "Pairing Queue after delete");
+
+        std::cout << "Key update operations\n";
+        std::cout << "---------------------\n";
+
+        pairing_priority_queue::handle task_v = queue.insert_value("Task V", 5);
+        pairing_priority_queue::handle task_u = queue.insert_value("Task U", 10);
+        queue.increase_priority(task_v, 100);
+        std::cout << "Max after raising Task V to 100: " << queue.search_value() << "\n";
+        queue.erase(task_u);
+        print_queue(queue, "Pairing Queue after erasing Task U");
+
+        try {
+            queue.increase_priority(task_v, 1);
+        }
+        catch (const char* msg) {
+            std::cout << "Expected error: " << msg << "\n\n";
+        }
+
+        std::cout << "Merge and meld\n";
+        std::cout << "--------------\n";
+
+        pairing_priority_queue other;
+        other.add_value("Critical", 200);
+        other.add_value("Minor", 1);
+
+        pairing_priority_queue melded = queue.meld(other);
+        queue.merge(std::move(other));
+        print_queue(queue, "Pairing Queue after merge");
+        std::cout << "Donor size: " << other.size() << ", melded size: " << melded.size() << "\n\n";
+
+        std::cout << "Long sibling chains\n";
+        std::cout << "-------------------\n";
+
+        // После n вставок без извлечений у корня n - 1 детей; копия и разрушение
+        // идут без рекурсии, поэтому глубина стека от n не зависит
+        {
+            basic_pairing_priority_queue<int> chain;
+            for (int i = 0; i < 2000000; ++i) {
+                chain.add_value(i, i);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            basic_pairing_priority_queue<int> copy = chain;
+            auto finish = std::chrono::steady_clock::now();
+            std::cout << "Copied " << copy.size() << " nodes in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count() << " ms\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+#endif
@@ -0,0 +1,466 @@
+// Сравнение реализаций через интерфейс priority_queue на воспроизводимых нагрузках.
+// Каждый случай (реализация, нагрузка) по умолчанию идёт в отдельном процессе этой же
+// программы, чтобы пиковый RSS относился только к нему. Результат - CSV или JSON:
+//   priority_queue_benchmark [--n 1000000] [--seed 1] [--format csv|json]
+//                            [--impl binary] [--workload hold] [--no-isolate]
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#define popen _popen
+#define pclose _pclose
+#else
+#include <sys/resource.h>
+#endif
+#include "binary_priority_queue.cpp"
+#include "binomial_priority_queue.cpp"
+#include "fibonacci_priority_queue.cpp"
+#include "leftist_priority_queue.cpp"
+#include "skew_priority_queue.cpp"
+#include "treap_priority_queue.cpp"
+#include "pairing_priority_queue.cpp"
+#include "allocation_counter.h"
+
+// Пиковый размер резидентной памяти процесса в килобайтах
+long long peak_rss_kb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<long long>(usage.ru_maxrss / 1024);
+#else
+    return static_cast<long long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Замер участка нагрузки: время и выделения между begin и end. С приёмником
+// замеров каждая SAMPLE_EVERY-я операция дополнительно замеряется отдельно
+class measurement {
+    static constexpr int SAMPLE_EVERY = 4;
+
+    std::vector<std::uint32_t>* samples;
+    int countdown;
+    std::chrono::steady_clock::time_point start;
+    long long allocations_at_start;
+
+public:
+    double elapsed_ns;
+    long long allocations;
+
+    explicit measurement(std::vector<std::uint32_t>* sink)
+        : samples(sink), countdown(SAMPLE_EVERY), allocations_at_start(0), elapsed_ns(0), allocations(0) {
+    }
+
+    void begin() {
+        allocations_at_start = allocation_count;
+        start = std::chrono::steady_clock::now();
+    }
+
+    void end() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        allocations = allocation_count - allocations_at_start;
+    }
+
+    template <typename Op>
+    void op(Op run) {
+        if (!samples || --countdown > 0) {
+            run();
+            return;
+        }
+
+        countdown = SAMPLE_EVERY;
+        auto op_start = std::chrono::steady_clock::now();
+        run();
+        auto elapsed = std::chrono::steady_clock::now() - op_start;
+        samples->push_back(static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+};
+
+using item_list = std::vector<std::pair<const char*, int>>;
+
+struct implementation {
+    const char* name;
+    std::unique_ptr<priority_queue> (*make)();
+    std::unique_ptr<priority_queue> (*bulk_load)(const item_list& items);
+};
+
+template <typename Queue>
+implementation describe(const char* name) {
+    return {
+        name,
+        [] { return std::unique_ptr<priority_queue>(new Queue()); },
+        [](const item_list& items) {
+            auto queue = std::make_unique<Queue>();
+            queue->add_range(items.begin(), items.end());
+            return std::unique_ptr<priority_queue>(std::move(queue));
+        }
+    };
+}
+
+const std::vector<implementation>& implementations() {
+    static const std::vector<implementation> all = {
+        describe<binary_priority_queue>("binary"),
+        describe<binomial_priority_queue>("binomial"),
+        describe<fibonacci_priority_queue>("fibonacci"),
+        describe<leftist_priority_queue>("leftist"),
+        describe<skew_priority_queue>("skew"),
+        describe<treap_priority_queue>("treap"),
+        describe<pairing_priority_queue>("pairing")
+    };
+    return all;
+}
+
+// Строки задач: 1024 имени, как у очереди с повторяющимися типами заданий
+const char* payload(int index) {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (int i = 0; i < 1024; ++i) {
+            result.push_back("job-" + std::to_string(i));
+        }
+        return result;
+    }();
+    return names[index & 1023].c_str();
+}
+
+std::vector<int> random_priorities(int count, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::vector<int> priorities(count);
+    for (int& priority : priorities) {
+        priority = static_cast<int>(generator() >> 2);
+    }
+    return priorities;
+}
+
+// Вставка count элементов с заданными приоритетами, затем полное опустошение
+long long fill_then_drain(const implementation& impl, const std::vector<int>& priorities, measurement& timed) {
+    auto queue = impl.make();
+    int count = static_cast<int>(priorities.size());
+
+    timed.begin();
+    for (int i = 0; i < count; ++i) {
+        timed.op([&] { queue->add_value(payload(i), priorities[i]); });
+    }
+    for (int i = 0; i < count; ++i) {
+        timed.op([&] { queue->delete_value(); });
+    }
+    timed.end();
+    return 2LL * count;
+}
+
+long long random_workload(const implementation& impl, int n, unsigned seed, measurement& timed) {
+    return fill_then_drain(impl, random_priorities(n, seed), timed);
+}
+
+// Каждая вставка - новая вершина
+long long monotone_workload(const implementation& impl, int n, unsigned, measurement& timed) {
+    std::vector<int> priorities(n);
+    std::iota(priorities.begin(), priorities.end(), 0);
+    return fill_then_drain(impl, priorities, timed);
+}
+
+// Пилообразные приоритеты: подъёмы длиной 1000
+long long sawtooth_workload(const implementation& impl, int n, unsigned, measurement& timed) {
+    std::vector<int> priorities(n);
+    for (int i = 0; i < n; ++i) {
+        priorities[i] = i % 1000;
+    }
+    return fill_then_drain(impl, priorities, timed);
+}
+
+// Модель удержания: очередь из n/4 элементов, затем n операций "извлечь вершину и вставить
+// элемент с приоритетом ниже извлечённого на случайный шаг". Операция - пара извлечение + вставка
+long long hold_workload(const implementation& impl, int n, unsigned seed, measurement& timed) {
+    auto queue = impl.make();
+    std::vector<int> initial = random_priorities(n / 4 + 1, seed);
+    for (int i = 0; i < static_cast<int>(initial.size()); ++i) {
+        queue->add_value(payload(i), initial[i]);
+    }
+
+    std::mt19937 generator(seed + 1);
+    std::vector<int> steps(n);
+    for (int& step : steps) {
+        step = static_cast<int>(generator() & 1023);
+    }
+
+    timed.begin();
+    for (int i = 0; i < n; ++i) {
+        timed.op([&] {
+            const char* top;
+            int priority;
+            queue->try_peek(top, priority);
+            queue->delete_value();
+            queue->add_value(payload(i), priority - steps[i]);
+        });
+    }
+    timed.end();
+    return n;
+}
+
+// Турнир слияний: n/64 очередей по 64 элемента сливаются попарно перемещением,
+// победитель каждой пары отдаёт вершину. Операция - слияние + извлечение
+long long meld_workload(const implementation& impl, int n, unsigned seed, measurement& timed) {
+    int queue_count = n / 64 > 2 ? n / 64 : 2;
+    std::vector<int> priorities = random_priorities(queue_count * 64, seed);
+    std::vector<std::unique_ptr<priority_queue>> queues;
+    for (int q = 0; q < queue_count; ++q) {
+        queues.push_back(impl.make());
+        for (int i = 0; i < 64; ++i) {
+            queues.back()->add_value(payload(i), priorities[q * 64 + i]);
+        }
+    }
+
+    long long melds = 0;
+    timed.begin();
+    for (int step = 1; step < queue_count; step *= 2) {
+        for (int i = 0; i + step < queue_count; i += 2 * step) {
+            timed.op([&] {
+                queues[i]->merge(std::move(*queues[i + step]));
+                queues[i]->delete_value();
+            });
+            ++melds;
+        }
+    }
+    timed.end();
+    return melds;
+}
+
+// Пакетная загрузка n пар одной операцией add_range; задержки отдельных операций нет
+long long bulk_workload(const implementation& impl, int n, unsigned seed, measurement& timed) {
+    std::vector<int> priorities = random_priorities(n, seed);
+    item_list items(n);
+    for (int i = 0; i < n; ++i) {
+        items[i] = { payload(i), priorities[i] };
+    }
+
+    timed.begin();
+    auto queue = impl.bulk_load(items);
+    timed.end();
+    return n;
+}
+
+// Опустошение заранее заполненной очереди
+long long drain_workload(const implementation& impl, int n, unsigned seed, measurement& timed) {
+    auto queue = impl.make();
+    std::vector<int> priorities = random_priorities(n, seed);
+    for (int i = 0; i < n; ++i) {
+        queue->add_value(payload(i), priorities[i]);
+    }
+
+    timed.begin();
+    for (int i = 0; i < n; ++i) {
+        timed.op([&] { queue->delete_value(); });
+    }
+    timed.end();
+    return n;
+}
+
+struct workload {
+    const char* name;
+    long long (*run)(const implementation& impl, int n, unsigned seed, measurement& timed);
+};
+
+const std::vector<workload>& workloads() {
+    static const std::vector<workload> all = {
+        { "random", random_workload },
+        { "monotone", monotone_workload },
+        { "sawtooth", sawtooth_workload },
+        { "hold", hold_workload },
+        { "meld", meld_workload },
+        { "bulk_load", bulk_workload },
+        { "drain", drain_workload }
+    };
+    return all;
+}
+
+struct case_result {
+    std::string implementation;
+    std::string workload;
+    long long ops;
+    double ns_per_op;
+    double allocations_per_op;
+    long long peak_rss_kb;
+    bool has_latency;
+    double p50_ns;
+    double p99_ns;
+};
+
+// Первый прогон даёт время, выделения и пиковый RSS, второй - выборку задержек
+case_result run_case(const implementation& impl, const workload& load, int n, unsigned seed) {
+    payload(0);
+    measurement plain(nullptr);
+    long long ops = load.run(impl, n, seed, plain);
+    long long rss = peak_rss_kb();
+
+    std::vector<std::uint32_t> samples;
+    samples.reserve(static_cast<std::size_t>(ops / 4 + 1));
+    measurement sampled(&samples);
+    load.run(impl, n, seed, sampled);
+    std::sort(samples.begin(), samples.end());
+
+    case_result result{ impl.name, load.name, ops, plain.elapsed_ns / ops,
+                        static_cast<double>(plain.allocations) / ops, rss, !samples.empty(), 0, 0 };
+    if (result.has_latency) {
+        result.p50_ns = samples[(samples.size() - 1) / 2];
+        result.p99_ns = samples[static_cast<std::size_t>(0.99 * (samples.size() - 1))];
+    }
+    return result;
+}
+
+const char* CSV_HEADER = "implementation,workload,n,seed,ops,ns_per_op,allocs_per_op,peak_rss_kb,p50_ns,p99_ns";
+
+void print_csv_row(std::ostream& os, const case_result& result, int n, unsigned seed) {
+    os << result.implementation << "," << result.workload << "," << n << "," << seed << "," << result.ops << ","
+       << result.ns_per_op << "," << result.allocations_per_op << "," << result.peak_rss_kb << ",";
+    if (result.has_latency) {
+        os << result.p50_ns << "," << result.p99_ns;
+    }
+    else {
+        os << ",";
+    }
+    os << "\n";
+}
+
+void print_json(std::ostream& os, const std::vector<case_result>& results, int n, unsigned seed) {
+    os << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const case_result& result = results[i];
+        os << "  {\"implementation\": \"" << result.implementation << "\", \"workload\": \"" << result.workload
+           << "\", \"n\": " << n << ", \"seed\": " << seed << ", \"ops\": " << result.ops
+           << ", \"ns_per_op\": " << result.ns_per_op << ", \"allocs_per_op\": " << result.allocations_per_op
+           << ", \"peak_rss_kb\": " << result.peak_rss_kb << ", \"p50_ns\": ";
+        if (result.has_latency) {
+            os << result.p50_ns << ", \"p99_ns\": " << result.p99_ns;
+        }
+        else {
+            os << "null, \"p99_ns\": null";
+        }
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "]\n";
+}
+
+// Строка CSV дочернего процесса обратно в результат
+case_result parse_csv_row(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        fields.push_back(field);
+    }
+    if (fields.size() == 8) fields.emplace_back();
+    if (fields.size() == 9) fields.emplace_back();
+    if (fields.size() != 10) throw "Malformed benchmark output";
+
+    case_result result{ fields[0], fields[1], std::atoll(fields[4].c_str()), std::atof(fields[5].c_str()),
+                        std::atof(fields[6].c_str()), std::atoll(fields[7].c_str()), !fields[8].empty(), 0, 0 };
+    if (result.has_latency) {
+        result.p50_ns = std::atof(fields[8].c_str());
+        result.p99_ns = std::atof(fields[9].c_str());
+    }
+    return result;
+}
+
+// Запуск случая в дочернем процессе: он печатает одну строку CSV без заголовка
+case_result run_isolated(const char* program, const implementation& impl, const workload& load, int n, unsigned seed) {
+    std::string command = std::string("\"") + program + "\" --case " + impl.name + " " + load.name +
+                          " --n " + std::to_string(n) + " --seed " + std::to_string(seed);
+    FILE* child = popen(command.c_str(), "r");
+    if (!child) throw "Cannot start benchmark process";
+
+    std::string line;
+    char buffer[512];
+    while (std::fgets(buffer, sizeof(buffer), child)) {
+        line += buffer;
+    }
+    if (pclose(child) != 0) throw "Benchmark process failed";
+
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+        line.pop_back();
+    }
+    return parse_csv_row(line);
+}
+
+template <typename Entry>
+const Entry& find_entry(const std::vector<Entry>& entries, const std::string& name) {
+    for (const Entry& entry : entries) {
+        if (name == entry.name) return entry;
+    }
+    throw "Unknown implementation or workload";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        int n = 1000000;
+        unsigned seed = 1;
+        std::string format = "csv";
+        std::string only_impl;
+        std::string only_workload;
+        bool isolate = true;
+        const char* case_impl = nullptr;
+        const char* case_workload = nullptr;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--n" && has_value) n = std::atoi(argv[++i]);
+            else if (arg == "--seed" && has_value) seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--format" && has_value) format = argv[++i];
+            else if (arg == "--impl" && has_value) only_impl = argv[++i];
+            else if (arg == "--workload" && has_value) only_workload = argv[++i];
+            else if (arg == "--no-isolate") isolate = false;
+            else if (arg == "--case" && i + 2 < argc) {
+                case_impl = argv[++i];
+                case_workload = argv[++i];
+            }
+            else throw "Unknown argument";
+        }
+        if (n <= 0) throw "Invalid size: must be positive";
+        if (format != "csv" && format != "json") throw "Unknown format";
+
+        if (case_impl) {
+            case_result result = run_case(find_entry(implementations(), case_impl),
+                                          find_entry(workloads(), case_workload), n, seed);
+            print_csv_row(std::cout, result, n, seed);
+            return 0;
+        }
+
+        std::vector<case_result> results;
+        for (const implementation& impl : implementations()) {
+            if (!only_impl.empty() && only_impl != impl.name) continue;
+            for (const workload& load : workloads()) {
+                if (!only_workload.empty() && only_workload != load.name) continue;
+                results.push_back(isolate ? run_isolated(argv[0], impl, load, n, seed)
+                                          : run_case(impl, load, n, seed));
+            }
+        }
+
+        if (format == "json") {
+            print_json(std::cout, results, n, seed);
+        }
+        else {
+            std::cout << CSV_HEADER << "\n";
+            for (const case_result& result : results) {
+                print_csv_row(std::cout, result, n, seed);
+            }
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#ifndef QUEUE_SNAPSHOT_H
+#define QUEUE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Снимок содержимого очереди одним непрерывным потоком:
+//   заголовок: "PQSNAP1\0", флаги (uint32), резерв (uint32), число записей (uint64)
+//   запись:    приоритет (int32), длина строки (uint32), строка и завершающий '\0'
+// Порядок байт - порядок машины, записавшей снимок. Завершающий ноль позволяет
+// интернировать строки прямо из отображённого в память файла, без копии.
+// Записи идут в порядке обхода очереди (for_each), а не в порядке извлечения
+
+// Очередь, чей for_each выдаёт элементы в порядке массива двоичной кучи с наибольшим
+// приоритетом в вершине. Её снимок помечается, и двоичная куча загружает его без перестройки
+template <typename Queue>
+struct snapshot_in_heap_order : std::false_type {};
+
+class snapshot_view final {
+public:
+    static constexpr std::uint32_t HEAP_ORDERED = 1;
+
+private:
+    static constexpr char MAGIC[8] = { 'P', 'Q', 'S', 'N', 'A', 'P', '1', '\0' };
+    static constexpr std::size_t HEADER_SIZE = 24;
+    static constexpr std::size_t RECORD_HEADER_SIZE = 8;
+
+    const char* data;
+    const char* data_end;
+    std::uint32_t flags;
+    std::uint64_t count;
+
+    template <typename Field>
+    static Field read_field(const char* source) {
+        Field field;
+        std::memcpy(&field, source, sizeof(field));
+        return field;
+    }
+
+    template <typename Field>
+    static void write_field(std::ostream& os, Field field) {
+        os.write(reinterpret_cast<const char*>(&field), sizeof(field));
+    }
+
+    friend class snapshot_writer;
+
+public:
+    // Записи читаются по мере обхода: снимок из отображённого файла подгружается
+    // страницами по требованию, повреждение обнаруживается на испорченной записи.
+    // remaining - сколько записей ещё обещано заголовком: конец данных раньше
+    // или лишние записи после последней обещанной - тоже повреждение
+    class iterator {
+        const char* position;
+        const char* end;
+        std::uint64_t remaining;
+        std::pair<const char*, int> current;
+
+        void read_current() {
+            if (position == end) {
+                if (remaining != 0) throw "Invalid snapshot: record count mismatch";
+                return;
+            }
+            if (remaining == 0) throw "Invalid snapshot: record count mismatch";
+            if (static_cast<std::size_t>(end - position) < RECORD_HEADER_SIZE) throw "Invalid snapshot: truncated";
+
+            auto length = read_field<std::uint32_t>(position + 4);
+            if (static_cast<std::size_t>(end - position) - RECORD_HEADER_SIZE <= length ||
+                position[RECORD_HEADER_SIZE + length] != '\0') {
+                throw "Invalid snapshot: truncated";
+            }
+
+            current.first = position + RECORD_HEADER_SIZE;
+            current.second = static_cast<int>(read_field<std::int32_t>(position));
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<const char*, int>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        iterator(const char* first, const char* last, std::uint64_t records)
+            : position(first), end(last), remaining(records), current(nullptr, 0) {
+            read_current();
+        }
+
+        reference operator*() const {
+            return current;
+        }
+
+        pointer operator->() const {
+            return &current;
+        }
+
+        iterator& operator++() {
+            position += RECORD_HEADER_SIZE + read_field<std::uint32_t>(position + 4) + 1;
+            --remaining;
+            read_current();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return position != other.position;
+        }
+    };
+
+    snapshot_view(const char* bytes, std::size_t length) : data(bytes), data_end(bytes + length) {
+        if (length < HEADER_SIZE || std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0) {
+            throw "Invalid snapshot: bad header";
+        }
+        flags = read_field<std::uint32_t>(bytes + 8);
+        count = read_field<std::uint64_t>(bytes + 16);
+        if (count > static_cast<std::uint64_t>(INT32_MAX)) throw "Invalid snapshot: too many records";
+
+        // Самая короткая запись - заголовок и завершающий ноль пустой строки: число записей,
+        // которым не хватит длины файла, отвергается до того, как под них резервируют память
+        if (count * (RECORD_HEADER_SIZE + 1) > length - HEADER_SIZE) {
+            throw "Invalid snapshot: too many records";
+        }
+    }
+
+    [[nodiscard]] iterator begin() const {
+        return iterator(data + HEADER_SIZE, data_end, count);
+    }
+
+    [[nodiscard]] iterator end() const {
+        return iterator(data_end, data_end, 0);
+    }
+
+    [[nodiscard]] int size() const {
+        return static_cast<int>(count);
+    }
+
+    [[nodiscard]] bool is_heap_ordered() const {
+        return (flags & HEAP_ORDERED) != 0;
+    }
+};
+
+// Пишет заголовок и записи; число записей известно заранее
+class snapshot_writer final {
+    std::ostream& os;
+    std::uint64_t remaining;
+
+public:
+    snapshot_writer(std::ostream& stream, int count, std::uint32_t flags) : os(stream), remaining(count) {
+        os.write(snapshot_view::MAGIC, sizeof(snapshot_view::MAGIC));
+        snapshot_view::write_field<std::uint32_t>(os, flags);
+        snapshot_view::write_field<std::uint32_t>(os, 0);
+        snapshot_view::write_field<std::uint64_t>(os, static_cast<std::uint64_t>(count));
+    }
+
+    void add(const char* str, int priority) {
+        if (remaining == 0) throw "Snapshot record count mismatch";
+        --remaining;
+
+        auto length = static_cast<std::uint32_t>(std::strlen(str));
+        snapshot_view::write_field<std::int32_t>(os, priority);
+        snapshot_view::write_field<std::uint32_t>(os, length);
+        os.write(str, length + 1);
+    }
+
+    void finish() {
+        if (remaining != 0) throw "Snapshot record count mismatch";
+        if (!os) throw "Snapshot write failed";
+    }
+};
+
+// Снимок любой очереди интерфейса с обходом for_each(visit(value, priority))
+template <typename Queue>
+void save_snapshot(const Queue& queue, std::ostream& os) {
+    snapshot_writer writer(os, queue.size(), snapshot_in_heap_order<Queue>::value ? snapshot_view::HEAP_ORDERED : 0);
+    queue.for_each([&writer](const auto& value, int priority) {
+        writer.add(value.c_str(), priority);
+    });
+    writer.finish();
+}
+
+// Загрузка за линейное время пакетной вставкой add_range; у двоичной кучи своя перегрузка
+template <typename Queue>
+void load_snapshot(Queue& queue, const snapshot_view& snapshot) {
+    queue.add_range(snapshot.begin(), snapshot.end());
+}
+
+// Снимок, прочитанный из потока целиком
+inline std::vector<char> read_snapshot(std::istream& is) {
+    return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+// Файл снимка, отображённый в память только для чтения: страницы подгружаются
+// системой при первом обращении к записям
+class mapped_snapshot final {
+    const char* bytes;
+    std::size_t length;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+public:
+    explicit mapped_snapshot(const char* path) : bytes(nullptr), length(0) {
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw "Cannot open snapshot file";
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            throw "Invalid snapshot: bad header";
+        }
+        length = static_cast<std::size_t>(file_size.QuadPart);
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            throw "Cannot map snapshot file";
+        }
+        bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!bytes) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            throw "Cannot map snapshot file";
+        }
+#else
+        int descriptor = open(path, O_RDONLY);
+        if (descriptor < 0) throw "Cannot open snapshot file";
+
+        struct stat info;
+        if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+            close(descriptor);
+            throw "Invalid snapshot: bad header";
+        }
+        length = static_cast<std::size_t>(info.st_size);
+
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (address == MAP_FAILED) throw "Cannot map snapshot file";
+
+        // Загрузка читает снимок подряд: ядро может подгружать страницы с опережением
+        madvise(address, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(address);
+#endif
+    }
+
+    mapped_snapshot(const mapped_snapshot&) = delete;
+    mapped_snapshot& operator=(const mapped_snapshot&) = delete;
+
+    ~mapped_snapshot() {
+#if defined(_WIN32)
+        UnmapViewOfFile(bytes);
+        CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+
+    [[nodiscard]] snapshot_view view() const {
+        return snapshot_view(bytes, length);
+    }
+};
+
+#endif //QUEUE_SNAPSHOT_H
@@ -0,0 +1,587 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#include "5z.h"
+#include "node_pool.h"
+
+// Число значащих бит: 0 для нуля, 1 для единицы, 64 для старшего бита
+inline int bit_length(std::uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    return _BitScanReverse64(&index, value) ? static_cast<int>(index) + 1 : 0;
+#else
+    return value ? 64 - __builtin_clzll(value) : 0;
+#endif
+}
+
+// Номер младшего единичного бита ненулевого слова
+inline int trailing_zeros(std::uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Очередь без сравнений элементов для целых приоритетов. Приоритет переводится в беззнаковый
+// ключ, который растёт от лучшего приоритета к худшему, и элементы раскладываются по корзинам.
+// Два режима:
+// - поразрядная куча (по умолчанию): монотонная очередь, как в алгоритме Дейкстры. Новый
+//   приоритет не может быть лучше последнего прочитанного или извлечённого с вершины.
+//   Корзина i хранит ключи, у которых старший отличающийся от последнего ключа бит - i-1,
+//   поэтому каждый элемент переезжает не больше KEY_BITS раз: O(log C) амортизированно;
+// - очередь корзин для ограниченного диапазона [first, second]: корзина на каждое значение,
+//   порядок вставки произвольный, вставка O(1), извлечение - сдвиг курсора до непустой корзины
+//   по битовой карте занятых корзин (64 корзины за одно слово).
+// Compare - std::less (сверху наибольший) или std::greater (сверху наименьший)
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_radix_priority_queue {
+    static_assert(std::is_integral_v<Priority>, "radix heap needs integer priorities");
+    static_assert(std::is_same_v<Compare, std::less<Priority>> || std::is_same_v<Compare, std::greater<Priority>>,
+                  "radix heap supports std::less and std::greater only");
+
+    using key_type = std::make_unsigned_t<Priority>;
+
+    static constexpr int KEY_BITS = std::numeric_limits<key_type>::digits;
+    static constexpr std::size_t MAX_BUCKET_RANGE = std::size_t(1) << 22;
+
+    struct entry {
+        key_type key;
+        T value;
+    };
+
+    // Корзины, курсор и последний ключ меняет и чтение вершины: поразрядная куча
+    // переносит элементы в корзину 0 лениво, при первом обращении к вершине
+    mutable std::vector<std::vector<entry>> buckets;
+    mutable std::size_t cursor;
+    mutable key_type last;
+    std::vector<std::uint64_t> occupied;
+    key_type low_key;
+    bool bounded;
+    int current_size;
+
+    // Знаковый приоритет сдвигается в беззнаковый с сохранением порядка,
+    // для std::less порядок обращается, чтобы вершиной был наименьший ключ
+    static key_type key_of(Priority priority) {
+        key_type key = static_cast<key_type>(priority);
+        if constexpr (std::is_signed_v<Priority>) {
+            key = static_cast<key_type>(key ^ (key_type(1) << (KEY_BITS - 1)));
+        }
+        if constexpr (std::is_same_v<Compare, std::less<Priority>>) {
+            key = static_cast<key_type>(~key);
+        }
+        return key;
+    }
+
+    static Priority priority_of(key_type key) {
+        if constexpr (std::is_same_v<Compare, std::less<Priority>>) {
+            key = static_cast<key_type>(~key);
+        }
+        if constexpr (std::is_signed_v<Priority>) {
+            key = static_cast<key_type>(key ^ (key_type(1) << (KEY_BITS - 1)));
+        }
+        return static_cast<Priority>(key);
+    }
+
+    [[nodiscard]] std::size_t radix_index(key_type key) const {
+        return static_cast<std::size_t>(bit_length(static_cast<std::uint64_t>(key ^ last)));
+    }
+
+    void check_key(key_type key) const {
+        if (bounded) {
+            if (key < low_key || key - low_key >= buckets.size()) throw "Priority out of range";
+        }
+        else if (key < last) {
+            throw "Priority breaks monotone order";
+        }
+    }
+
+    // Поразрядная куча: первая непустая корзина раскладывается относительно своего
+    // наименьшего ключа, и он со всеми равными ему попадает в корзину 0
+    void refill() const {
+        std::size_t index = 1;
+        while (buckets[index].empty()) {
+            ++index;
+        }
+
+        std::vector<entry>& source = buckets[index];
+        key_type smallest = source[0].key;
+        for (const entry& item : source) {
+            if (item.key < smallest) smallest = item.key;
+        }
+
+        last = smallest;
+        for (entry& item : source) {
+            buckets[radix_index(item.key)].push_back(std::move(item));
+        }
+        source.clear();
+    }
+
+    // Гарантирует, что вершина лежит последней в корзине cursor
+    void prepare_top() const {
+        if (is_empty()) throw "Queue is empty";
+        if (!bounded && buckets[0].empty()) refill();
+    }
+
+    // Первая занятая корзина не раньше from; вызывается, только когда такая есть
+    [[nodiscard]] std::size_t next_occupied(std::size_t from) const {
+        std::size_t word = from / 64;
+        std::uint64_t bits = occupied[word] & (~std::uint64_t(0) << (from % 64));
+        while (!bits) {
+            bits = occupied[++word];
+        }
+        return word * 64 + trailing_zeros(bits);
+    }
+
+    void pop_top() {
+        buckets[cursor].pop_back();
+        --current_size;
+
+        if (bounded && buckets[cursor].empty()) {
+            occupied[cursor / 64] &= ~(std::uint64_t(1) << (cursor % 64));
+            if (current_size > 0) cursor = next_occupied(cursor);
+        }
+    }
+
+    template <typename Value>
+    void insert_checked(Value&& value, key_type key) {
+        if (bounded) {
+            std::size_t index = static_cast<std::size_t>(key - low_key);
+            buckets[index].push_back({ key, std::forward<Value>(value) });
+            occupied[index / 64] |= std::uint64_t(1) << (index % 64);
+            if (current_size == 0 || index < cursor) cursor = index;
+        }
+        else {
+            buckets[radix_index(key)].push_back({ key, std::forward<Value>(value) });
+        }
+        ++current_size;
+    }
+
+    // Проверка до первой вставки: слияние либо проходит целиком, либо не меняет очередь
+    void check_mergeable(const basic_radix_priority_queue& other) const {
+        for (const auto& bucket : other.buckets) {
+            for (const entry& item : bucket) {
+                check_key(item.key);
+            }
+        }
+    }
+
+public:
+    basic_radix_priority_queue()
+        : buckets(KEY_BITS + 1),
+          cursor(0),
+          last(0),
+          low_key(0),
+          bounded(false),
+          current_size(0) {
+    }
+
+    // Очередь корзин для приоритетов из диапазона [first, second] в любом порядке
+    basic_radix_priority_queue(Priority first, Priority second)
+        : cursor(0),
+          last(0),
+          low_key(0),
+          bounded(true),
+          current_size(0) {
+        key_type first_key = key_of(first);
+        key_type second_key = key_of(second);
+        if (first_key > second_key) std::swap(first_key, second_key);
+
+        if (static_cast<std::uint64_t>(second_key - first_key) >= MAX_BUCKET_RANGE) {
+            throw "Invalid range: too many buckets";
+        }
+
+        low_key = first_key;
+        buckets.resize(static_cast<std::size_t>(second_key - first_key) + 1);
+        occupied.resize((buckets.size() + 63) / 64, 0);
+    }
+
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        key_type key = key_of(priority);
+        check_key(key);
+        insert_checked(std::forward<Value>(value), key);
+    }
+
+    [[nodiscard]] const T& search_value() const {
+        prepare_top();
+        return buckets[cursor].back().value;
+    }
+
+    [[nodiscard]] Priority search_priority() const {
+        prepare_top();
+        return priority_of(buckets[cursor].back().key);
+    }
+
+    void delete_value() {
+        prepare_top();
+        pop_top();
+    }
+
+    [[nodiscard]] T extract_value() {
+        prepare_top();
+        T value = std::move(buckets[cursor].back().value);
+        pop_top();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка: каждый элемент за O(1) ложится в свою корзину.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        for (; first != last; ++first) {
+            add_value(make_value(first->first), first->second);
+        }
+    }
+
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    // Обход всех элементов по корзинам: visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        for (const auto& bucket : buckets) {
+            for (const entry& item : bucket) {
+                visit(item.value, priority_of(item.key));
+            }
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && current_size > 0; ++taken) {
+            prepare_top();
+            entry& top = buckets[cursor].back();
+            consume(std::move(top.value), priority_of(top.key));
+            pop_top();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Корзины упорядочены: любой ключ корзины меньше любого ключа следующей. Очередь корзин
+    // и корзина 0 поразрядной кучи (ключи равны last) выдаются с конца, как при извлечении;
+    // в остальных корзинах частично сортируется только нужная часть
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int visited = 0;
+        std::vector<const entry*> unsorted;
+        for (std::size_t index = bounded ? cursor : 0; visited < count && visited < current_size; ++index) {
+            if (bounded) index = next_occupied(index);
+
+            const std::vector<entry>& bucket = buckets[index];
+            if (bounded || index == 0) {
+                for (auto item = bucket.rbegin(); item != bucket.rend() && visited < count; ++item, ++visited) {
+                    visit(item->value, priority_of(item->key));
+                }
+                continue;
+            }
+
+            unsorted.clear();
+            for (const entry& item : bucket) {
+                unsorted.push_back(&item);
+            }
+            auto needed = std::min<std::size_t>(unsorted.size(), static_cast<std::size_t>(count - visited));
+            std::partial_sort(unsorted.begin(), unsorted.begin() + needed, unsorted.end(),
+                              [](const entry* first, const entry* second) { return first->key < second->key; });
+            for (std::size_t i = 0; i < needed; ++i, ++visited) {
+                visit(unsorted[i]->value, priority_of(unsorted[i]->key));
+            }
+        }
+        return visited;
+    }
+
+    basic_radix_priority_queue& merge(const basic_radix_priority_queue& other) {
+        if (this == &other) {
+            basic_radix_priority_queue copy(other);
+            return merge(std::move(copy));
+        }
+
+        check_mergeable(other);
+        for (const auto& bucket : other.buckets) {
+            for (const entry& item : bucket) {
+                insert_checked(item.value, item.key);
+            }
+        }
+        return *this;
+    }
+
+    // Пустая очередь того же режима забирает корзины донора целиком, иначе значения
+    // переносятся перемещением; донор остаётся пустым
+    basic_radix_priority_queue& merge(basic_radix_priority_queue&& other) {
+        if (this == &other) return *this;
+
+        check_mergeable(other);
+        if (current_size == 0 && bounded == other.bounded && low_key == other.low_key &&
+            buckets.size() == other.buckets.size() && (bounded || other.last >= last)) {
+            std::swap(buckets, other.buckets);
+            std::swap(occupied, other.occupied);
+            std::swap(cursor, other.cursor);
+            std::swap(last, other.last);
+            std::swap(current_size, other.current_size);
+        }
+        else {
+            for (auto& bucket : other.buckets) {
+                for (entry& item : bucket) {
+                    insert_checked(std::move(item.value), item.key);
+                }
+            }
+        }
+
+        other.clear();
+        return *this;
+    }
+
+    [[nodiscard]] basic_radix_priority_queue meld(const basic_radix_priority_queue& other) const {
+        basic_radix_priority_queue result(*this);
+        result.merge(other);
+        return result;
+    }
+
+    // Опустошает очередь; поразрядная куча снова принимает любые приоритеты
+    void clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        std::fill(occupied.begin(), occupied.end(), 0);
+        cursor = 0;
+        last = 0;
+        current_size = 0;
+    }
+
+    [[nodiscard]] bool is_empty() const {
+        return current_size == 0;
+    }
+
+    [[nodiscard]] int get_size() const {
+        return current_size;
+    }
+
+    [[nodiscard]] int size() const {
+        return current_size;
+    }
+
+    [[nodiscard]] bool is_bounded() const {
+        return bounded;
+    }
+
+    friend void print_queue(const basic_radix_priority_queue& queue, const char* name) {
+        std::cout << name << " (size: " << queue.get_size()
+                  << (queue.bounded ? ", bucket queue" : ", radix heap") << "):\n";
+
+        if (queue.is_empty()) {
+            std::cout << "  [EMPTY]\n\n";
+            return;
+        }
+
+        for (std::size_t i = 0; i < queue.buckets.size(); ++i) {
+            for (const entry& item : queue.buckets[i]) {
+                std::cout << "  bucket " << i << ": Priority " << priority_of(item.key)
+                          << ", Value: " << item.value << "\n";
+            }
+        }
+        std::cout << "\n";
+    }
+};
+
+// Реализация интерфейса priority_queue: строки интернируются в общем пуле процесса
+class radix_priority_queue final : public basic_radix_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_radix_priority_queue<pooled_string>;
+
+    static pooled_string intern(const char* str) {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(node_pool::process_default().intern(str));
+    }
+
+    static pooled_string intern(const std::string& str) {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        auto other_queue = dynamic_cast<const radix_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        auto other_queue = dynamic_cast<radix_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] radix_priority_queue meld(const radix_priority_queue& other) const {
+        radix_priority_queue result;
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+int main() {
+    try {
+        std::cout << "Radix heap (monotone priorities)\n";
+        std::cout << "--------------------------------\n";
+
+        radix_priority_queue radix_queue;
+        radix_queue.add_value("Task A", 40);
+        radix_queue.add_value("Task B", 10);
+        radix_queue.add_value("Task C", 30);
+        radix_queue.add_value("Task D", 40);
+        print_queue(radix_queue, "Radix queue after adding 4 tasks");
+
+        std::cout << "Max priority: " << radix_queue.search_value() << "\n";
+        radix_queue.delete_value();
+        std::cout << "After delete: " << radix_queue.search_value() << "\n";
+
+        // Приоритет 40 уже прочитан с вершины, лучше него вставлять нельзя
+        radix_queue.add_value("Task E", 35);
+        try {
+            radix_queue.add_value("Task F", 50);
+        }
+        catch (const char* msg) {
+            std::cout << "Expected error: " << msg << "\n";
+        }
+
+        std::cout << "Drain order:";
+        while (!radix_queue.is_empty()) {
+            std::cout << " " << radix_queue.search_value();
+            radix_queue.delete_value();
+        }
+        std::cout << "\n\n";
+
+        std::cout << "Bucket queue (priorities 0..7, any order)\n";
+        std::cout << "-----------------------------------------\n";
+
+        radix_priority_queue bucket_queue(0, 7);
+        bucket_queue.add_value("low", 1);
+        bucket_queue.add_value("high", 7);
+        bucket_queue.add_value("middle", 4);
+        std::cout << "Max priority: " << bucket_queue.search_value() << "\n";
+        bucket_queue.delete_value();
+        bucket_queue.add_value("urgent", 7);
+        print_queue(bucket_queue, "Bucket queue after pop and re-add");
+
+        try {
+            bucket_queue.add_value("too high", 8);
+        }
+        catch (const char* msg) {
+            std::cout << "Expected error: " << msg << "\n";
+        }
+
+        std::cout << "\nMerge and meld\n";
+        std::cout << "--------------\n";
+
+        radix_priority_queue other_bucket(0, 7);
+        other_bucket.add_value("other", 5);
+        radix_priority_queue melded = bucket_queue.meld(other_bucket);
+        bucket_queue.merge(std::move(other_bucket));
+        std::cout << "Merged size: " << bucket_queue.size() << ", donor size: " << other_bucket.size()
+                  << ", melded size: " << melded.size() << "\n";
+
+        std::cout << "\nMin-first radix heap over integers\n";
+        std::cout << "----------------------------------\n";
+
+        basic_radix_priority_queue<int, unsigned, std::greater<unsigned>> distances;
+        distances.add_value(1, 7u);
+        distances.add_value(2, 3u);
+        distances.add_value(3, 4000000000u);
+        std::cout << "Order:";
+        while (!distances.is_empty()) {
+            std::cout << " " << distances.search_priority();
+            distances.delete_value();
+        }
+        std::cout << "\n";
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+#endif
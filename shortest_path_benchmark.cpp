@@ -0,0 +1,103 @@
+// Сравнение очередей на кратчайших путях и на малых целых приоритетах.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include "binary_priority_queue.cpp"
+#include "fibonacci_priority_queue.cpp"
+#include "radix_priority_queue.cpp"
+
+// Дейкстра с ленивым удалением на любой обобщённой куче с порядком std::greater:
+// вершина - значение, расстояние - приоритет, устаревшие записи пропускаются
+template <typename Queue>
+std::vector<int> dijkstra_lazy(const weighted_graph& graph, int source) {
+    std::vector<int> dist(graph.vertex_count, INT_MAX);
+    Queue queue;
+
+    dist[source] = 0;
+    queue.add_value(source, 0);
+
+    while (!queue.is_empty()) {
+        int d = queue.search_priority();
+        int v = queue.extract_value();
+        if (d != dist[v]) continue;
+
+        for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            int u = graph.targets[e];
+            int candidate = d + graph.weights[e];
+            if (candidate < dist[u]) {
+                dist[u] = candidate;
+                queue.add_value(u, candidate);
+            }
+        }
+    }
+    return dist;
+}
+
+template <typename Run>
+long long elapsed_ms(Run run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Модель удержания: очередь из size элементов, затем пары извлечение + вставка
+// с приоритетами 0..255. Возвращает наносекунды на пару
+template <typename Queue>
+double hold_ns_per_op(Queue& queue, int size, int operations, unsigned seed) {
+    std::mt19937 generator(seed);
+    for (int i = 0; i < size; ++i) {
+        queue.add_value(i, static_cast<int>(generator() & 255));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < operations; ++i) {
+        int value = queue.extract_value();
+        queue.add_value(value, static_cast<int>(generator() & 255));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / operations;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        using binary_distances = basic_binary_priority_queue<int, int, std::greater<int>>;
+        using radix_distances = basic_radix_priority_queue<int, int, std::greater<int>>;
+
+        int max_vertices = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+        std::cout << "Dijkstra, 10 edges per vertex, weights 1..100 (ms)\n";
+        std::cout << "--------------------------------------------------\n";
+        for (int vertices = 100000; vertices <= max_vertices; vertices *= 10) {
+            weighted_graph graph = make_random_graph(vertices, 10, 2024);
+
+            std::vector<int> fib_dist, binary_dist, radix_dist;
+            long long fib_time = elapsed_ms([&] { fib_dist = dijkstra_fibonacci(graph, 0); });
+            long long binary_time = elapsed_ms([&] { binary_dist = dijkstra_lazy<binary_distances>(graph, 0); });
+            long long radix_time = elapsed_ms([&] { radix_dist = dijkstra_lazy<radix_distances>(graph, 0); });
+
+            std::cout << "  vertices = " << vertices << ": fibonacci " << fib_time << ", binary " << binary_time
+                      << ", radix " << radix_time << ", distances match: "
+                      << (fib_dist == binary_dist && binary_dist == radix_dist ? "true" : "false") << "\n";
+        }
+
+        std::cout << "\nHold model, priorities 0..255, 1000000 pop+push pairs (ns/pair)\n";
+        std::cout << "----------------------------------------------------------------\n";
+        for (int size = 1000; size <= 1000000; size *= 10) {
+            basic_binary_priority_queue<int> binary_queue;
+            basic_fibonacci_priority_queue<int> fibonacci_queue;
+            basic_radix_priority_queue<int> bucket_queue(0, 255);
+
+            double binary_time = hold_ns_per_op(binary_queue, size, 1000000, 3);
+            double fibonacci_time = hold_ns_per_op(fibonacci_queue, size, 1000000, 3);
+            double bucket_time = hold_ns_per_op(bucket_queue, size, 1000000, 3);
+
+            std::cout << "  size = " << size << ": binary " << binary_time << ", fibonacci " << fibonacci_time
+                      << ", bucket " << bucket_time << "\n";
+        }
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,101 +1,138 @@
 #include <iostream>
+#include <algorithm>
 #include <cstring>
-#include "C:\Users\arnau\source\repos\second_sem_labs\priority_queue.h"
-
-class skew_priority_queue final : public priority_queue {
+#include <functional>
+#include <utility>
+#include <vector>
+#include "node_pool.h"
+#include "5z.h"
+
+// Косая куча над произвольными значениями и приоритетами.
+// Compare задаёт порядок как в std::priority_queue: std::less - сверху наибольший
+// приоритет, std::greater - наименьший. Значения перемещаются в узлы и из них
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_skew_priority_queue {
 private:
+    // Узлы выделяются из node_pool
     struct Node {
-        char* value;
-        int priority;
+        T value;
+        Priority priority;
         Node* left;
         Node* right;
 
-        Node(const char* str, int p) : priority(p), left(nullptr), right(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                std::strcpy(value, str);
-            }
-            else {
-                value = nullptr;
-            }
-        }
-
-        Node(const Node& other) : priority(other.priority), left(nullptr), right(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
-            }
-            else {
-                value = nullptr;
-            }
-        }
+        template <typename Value>
+        Node(Value&& v, const Priority& p)
+            : value(std::forward<Value>(v)), priority(p), left(nullptr), right(nullptr) {}
 
-        Node& operator=(const Node& other) {
-            if (this != &other) {
-                delete[] value;
-                priority = other.priority;
-                if (other.value) {
-                    value = new char[std::strlen(other.value) + 1];
-                    std::strcpy(value, other.value);
-                }
-                else {
-                    value = nullptr;
-                }
-            }
-            return *this;
-        }
-
-        ~Node() {
-            delete[] value;
-        }
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
     };
 
     Node* root;
+    int node_count;
+    node_pool* pool;
+    Compare compare;
 
 private:
+    // Нисходящее слияние без рекурсии (правый путь косой кучи не ограничен):
+    // больший корень становится текущим узлом, его дети меняются местами,
+    // и слияние продолжается в новом левом поддереве
     Node* merge_nodes(Node* node1, Node* node2) const {
         if (!node1) return node2;
         if (!node2) return node1;
 
-        if (node1->priority < node2->priority) {
-            Node* temp = node1;
-            node1 = node2;
-            node2 = temp;
+        if (compare(node1->priority, node2->priority)) {
+            std::swap(node1, node2);
         }
 
-        Node* temp = node1->left;
-        node1->left = merge_nodes(node1->right, node2);
-        node1->right = temp;
+        Node* result = node1;
+        Node* current = node1;
+
+        while (true) {
+            Node* right = current->right;
+            current->right = current->left;
+
+            if (!right) {
+                current->left = node2;
+                break;
+            }
+
+            if (compare(right->priority, node2->priority)) {
+                std::swap(right, node2);
+            }
+
+            current->left = right;
+            current = right;
+        }
 
-        return node1;
+        return result;
     }
 
-    Node* copy_tree(Node* node) const{
+    Node* copy_tree(Node* node) const {
         if (!node) return nullptr;
-        Node* new_node = new Node(node->value, node->priority);
-        new_node->left = copy_tree(node->left);
-        new_node->right = copy_tree(node->right);
-        return new_node;
-    }
 
-    void delete_tree(Node* node) {
-        if (node) {
-            delete_tree(node->left);
-            delete_tree(node->right);
-            delete node;
+        Node* new_root = pool->template create<Node>(node->value, node->priority);
+        try {
+            std::vector<std::pair<Node*, Node*>> pending;
+            pending.push_back({ node, new_root });
+
+            while (!pending.empty()) {
+                Node* source = pending.back().first;
+                Node* target = pending.back().second;
+                pending.pop_back();
+
+                if (source->left) {
+                    target->left = pool->template create<Node>(source->left->value, source->left->priority);
+                    pending.push_back({ source->left, target->left });
+                }
+                if (source->right) {
+                    target->right = pool->template create<Node>(source->right->value, source->right->priority);
+                    pending.push_back({ source->right, target->right });
+                }
+            }
         }
+        catch (...) {
+            delete_tree(new_root);
+            throw;
+        }
+
+        return new_root;
     }
 
-    [[nodiscard]] int count_nodes(Node* node) const {
-        if (!node) return 0;
-        return 1 + count_nodes(node->left) + count_nodes(node->right);
+    // Удаление поворотами: левый ребёнок поднимается над родителем, пока левых
+    // детей не останется, после чего узел удаляется и обход идёт вправо
+    void delete_tree(Node* node) const {
+        while (node) {
+            if (node->left) {
+                Node* left = node->left;
+                node->left = left->right;
+                left->right = node;
+                node = left;
+            }
+            else {
+                Node* right = node->right;
+                pool->destroy(node);
+                node = right;
+            }
+        }
     }
 
     [[nodiscard]] int calculate_height(Node* node) const {
-        if (!node) return 0;
-        int left_height = calculate_height(node->left);
-        int right_height = calculate_height(node->right);
-        return 1 + (left_height > right_height ? left_height : right_height);
+        int height = 0;
+        std::vector<std::pair<Node*, int>> pending;
+        if (node) pending.push_back({ node, 1 });
+
+        while (!pending.empty()) {
+            Node* current = pending.back().first;
+            int depth = pending.back().second;
+            pending.pop_back();
+
+            if (depth > height) height = depth;
+            if (current->left) pending.push_back({ current->left, depth + 1 });
+            if (current->right) pending.push_back({ current->right, depth + 1 });
+        }
+
+        return height;
     }
 
     void print_tree(std::ostream& os, Node* node, int depth = 0) const {
@@ -106,75 +143,223 @@ private:
             os << "    ";
         }
 
-        os << "[" << node->priority << ": " << (node->value ? node->value : "null") << "]\n";
+        os << "[" << node->priority << ": " << node->value << "]\n";
 
         print_tree(os, node->left, depth + 1);
     }
 
 public:
-    skew_priority_queue() : root(nullptr) {}
+    basic_skew_priority_queue() : basic_skew_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_skew_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : root(nullptr), node_count(0), pool(&shared_pool), compare(order) {}
 
-    skew_priority_queue(const skew_priority_queue& other) {
+    basic_skew_priority_queue(const basic_skew_priority_queue& other)
+        : node_count(other.node_count), pool(other.pool), compare(other.compare) {
         root = copy_tree(other.root);
     }
 
-    skew_priority_queue& operator=(const skew_priority_queue& other) {
+    basic_skew_priority_queue& operator=(const basic_skew_priority_queue& other) {
         if (this != &other) {
+            Node* copy = copy_tree(other.root);
             delete_tree(root);
-            root = other.root ? copy_tree(other.root) : nullptr;
+            root = copy;
+            node_count = other.node_count;
+            compare = other.compare;
         }
         return *this;
     }
 
-    skew_priority_queue(skew_priority_queue&& other) noexcept : root(other.root) {
+    basic_skew_priority_queue(basic_skew_priority_queue&& other) noexcept
+        : root(other.root), node_count(other.node_count), pool(other.pool), compare(other.compare) {
         other.root = nullptr;
+        other.node_count = 0;
     }
 
-    skew_priority_queue& operator=(skew_priority_queue&& other) noexcept {
+    basic_skew_priority_queue& operator=(basic_skew_priority_queue&& other) noexcept {
         if (this != &other) {
             delete_tree(root);
             root = other.root;
+            node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
             other.root = nullptr;
+            other.node_count = 0;
         }
         return *this;
     }
 
-    ~skew_priority_queue() {
+    ~basic_skew_priority_queue() {
         delete_tree(root);
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
-
-        Node* new_node = new Node(str, priority);
+    template <typename Value>
+    void add_value(Value&& value, const Priority& priority) {
+        Node* new_node = pool->template create<Node>(std::forward<Value>(value), priority);
         root = merge_nodes(root, new_node);
+        node_count++;
     }
 
-    [[nodiscard]] const char* search_value() const override {
+    [[nodiscard]] const T& search_value() const {
         if (!root) throw "Queue is empty";
         return root->value;
     }
 
-    void delete_value() override {
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!root) throw "Queue is empty";
+        return root->priority;
+    }
+
+    void delete_value() {
         if (!root) throw "Queue is empty";
 
         Node* old_root = root;
         root = merge_nodes(root->left, root->right);
         old_root->left = nullptr;
         old_root->right = nullptr;
-        delete old_root;
+        pool->destroy(old_root);
+        node_count--;
     }
 
-    priority_queue& merge(const priority_queue& second) override {
-        const skew_priority_queue* other_queue =
-            dynamic_cast<const skew_priority_queue*>(&second);
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!root) throw "Queue is empty";
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+        T value = std::move(root->value);
+        delete_value();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка за O(n): одиночные узлы сливаются попарно кругами, как при
+    // построении снизу вверх, и результат один раз присоединяется к текущему дереву.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        std::vector<Node*> trees;
+        try {
+            for (; first != last; ++first) {
+                trees.push_back(pool->template create<Node>(make_value(first->first), first->second));
+            }
+        }
+        catch (...) {
+            attach_trees(trees);
+            throw;
+        }
+        attach_trees(trees);
+    }
+
+private:
+    void attach_trees(std::vector<Node*>& trees) {
+        node_count += static_cast<int>(trees.size());
+        while (trees.size() > 1) {
+            std::size_t joined = 0;
+            for (std::size_t i = 0; i + 1 < trees.size(); i += 2) {
+                trees[joined++] = merge_nodes(trees[i], trees[i + 1]);
+            }
+            if (trees.size() % 2 != 0) {
+                trees[joined++] = trees.back();
+            }
+            trees.resize(joined);
+        }
+        if (!trees.empty()) {
+            root = merge_nodes(root, trees[0]);
+        }
+    }
+
+public:
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
+
+    // Обход всех элементов в прямом порядке с явным стеком: visit(value, priority)
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const Node*> pending;
+        if (root) pending.push_back(root);
+
+        while (!pending.empty()) {
+            const Node* node = pending.back();
+            pending.pop_back();
+            visit(node->value, node->priority);
+
+            if (node->right) pending.push_back(node->right);
+            if (node->left) pending.push_back(node->left);
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && root; ++taken) {
+            consume(std::move(root->value), root->priority);
+            delete_value();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Обход по фронту от корня: выданный узел добавляет во фронт обоих детей,
+    // поэтому стоимость O(count log count) и не зависит от размера очереди
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const Node* first, const Node* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const Node*> frontier;
+        if (count > 0 && root) {
+            frontier.reserve(std::min<std::size_t>(count, node_count) + 1);
+            frontier.push_back(root);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const Node* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            ++visited;
+
+            for (const Node* child : { node->left, node->right }) {
+                if (child) {
+                    frontier.push_back(child);
+                    std::push_heap(frontier.begin(), frontier.end(), lower);
+                }
+            }
+        }
+        return visited;
+    }
+
+    basic_skew_priority_queue& merge(const basic_skew_priority_queue& other) {
+        root = merge_nodes(root, copy_tree(other.root));
+        node_count += other.node_count;
+        return *this;
+    }
+
+    // Слияние без копирования: узлы донора переходят в эту очередь, донор остаётся пустым
+    basic_skew_priority_queue& merge(basic_skew_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_skew_priority_queue&>(other));
+            other = basic_skew_priority_queue(*other.pool, other.compare);
+            return *this;
         }
 
-        root = merge_nodes(root, copy_tree(other_queue->root));
+        root = merge_nodes(root, other.root);
+        node_count += other.node_count;
+        other.root = nullptr;
+        other.node_count = 0;
         return *this;
     }
 
@@ -183,30 +368,34 @@ public:
     }
 
     [[nodiscard]] int get_size() const {
-        return count_nodes(root);
+        return node_count;
+    }
+
+    [[nodiscard]] int size() const {
+        return node_count;
+    }
+
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
     }
 
     [[nodiscard]] int get_height() const {
         return calculate_height(root);
     }
 
-    [[nodiscard]] skew_priority_queue meld(const skew_priority_queue& other) const {
-        skew_priority_queue result;
+    [[nodiscard]] basic_skew_priority_queue meld(const basic_skew_priority_queue& other) const {
+        basic_skew_priority_queue result(*pool, compare);
 
-        if (root && other.root) {
-            result.root = merge_nodes(copy_tree(root), copy_tree(other.root));
-        }
-        else if (root) {
-            result.root = copy_tree(root);
-        }
-        else if (other.root) {
-            result.root = copy_tree(other.root);
-        }
+        // Первая копия сразу принадлежит result: если вторая бросит исключение,
+        // деструктор result освободит её
+        result.root = copy_tree(root);
+        result.root = merge_nodes(result.root, copy_tree(other.root));
+        result.node_count = node_count + other.node_count;
 
         return result;
     }
 
-    friend void print_skew_queue(const skew_priority_queue& queue, const char* name) {
+    friend void print_skew_queue(const basic_skew_priority_queue& queue, const char* name) {
         std::cout << name << " (size: " << queue.get_size()
             << ", height: " << queue.get_height() << "):\n";
 
@@ -220,6 +409,105 @@ public:
     }
 };
 
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class skew_priority_queue final : public basic_skew_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_skew_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        const skew_priority_queue* other_queue =
+            dynamic_cast<const skew_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        skew_priority_queue* other_queue = dynamic_cast<skew_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] skew_priority_queue meld(const skew_priority_queue& other) const {
+        skew_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
+#ifndef PRIORITY_QUEUE_NO_DEMO
+// Значение с бросающей копией для проверки утечек при исключениях
+#include "throwing_copy_value.h"
+
 int main() {
     try {
         std::cout << "Basic operations\n";
@@ -339,6 +627,69 @@ int main() {
         std::cout << "Max via interface: " << interface_max << "\n";
         std::cout << "\n\n";
 
+        std::cout << "Monotone insert regression\n";
+        std::cout << "----------------------------------\n";
+
+        // Возрастающие приоритеты (типичные метки времени) вытягивают дерево в цепочку
+        {
+            const int monotone_count = 10000000;
+            skew_priority_queue monotone_queue;
+            for (int i = 0; i < monotone_count; ++i) {
+                monotone_queue.add_value("tick", i);
+            }
+            std::cout << "Inserted " << monotone_queue.get_size() << " increasing priorities\n";
+
+            for (int i = 0; i < 3; ++i) {
+                monotone_queue.delete_value();
+            }
+            std::cout << "Size after 3 pops: " << monotone_queue.get_size() << "\n";
+
+            skew_priority_queue monotone_copy = monotone_queue;
+            std::cout << "Copy size: " << monotone_copy.get_size() << "\n";
+        }
+
+        std::cout << "\nThrowing copy regression\n";
+        std::cout << "----------------------------------\n";
+
+        // Копия, прерванная исключением на середине, освобождает уже скопированные узлы
+        {
+            node_pool local_pool;
+            basic_skew_priority_queue<throwing_copy_value> source(local_pool);
+            for (int i = 0; i < 100; ++i) {
+                source.add_value(throwing_copy_value(), i);
+            }
+            int live_before = throwing_copy_value::live;
+
+            throwing_copy_value::copies_left = 50;
+            try {
+                basic_skew_priority_queue<throwing_copy_value> copy = source;
+            }
+            catch (const char* msg) {
+                std::cout << "Copy constructor: " << msg << "\n";
+            }
+
+            throwing_copy_value::copies_left = 50;
+            basic_skew_priority_queue<throwing_copy_value> assigned(local_pool);
+            try {
+                assigned = source;
+            }
+            catch (const char* msg) {
+                std::cout << "Copy assignment: " << msg << "\n";
+            }
+
+            // meld копирует оба дерева: исключение во второй копии не должно терять первую
+            throwing_copy_value::copies_left = 150;
+            try {
+                basic_skew_priority_queue<throwing_copy_value> melded = source.meld(source);
+            }
+            catch (const char* msg) {
+                std::cout << "Meld: " << msg << "\n";
+            }
+
+            std::cout << "Values leaked by failed copies: " << throwing_copy_value::live - live_before << "\n";
+            std::cout << "Assigned queue size: " << assigned.get_size() << "\n";
+        }
+
     }
     catch (const char* msg) {
         std::cerr << "Error: " << msg << "\n";
@@ -347,3 +698,4 @@ int main() {
 
     return 0;
 }
+#endif
@@ -0,0 +1,197 @@
+// Перезапуск очереди: повтор add_value против снимка, загруженного из отображённого файла.
+// Реализации подключаются целиком, их демонстрационные main отключены
+#define PRIORITY_QUEUE_NO_DEMO
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "binary_priority_queue.cpp"
+#include "binomial_priority_queue.cpp"
+#include "fibonacci_priority_queue.cpp"
+#include "leftist_priority_queue.cpp"
+#include "skew_priority_queue.cpp"
+#include "treap_priority_queue.cpp"
+#include "pairing_priority_queue.cpp"
+#include "queue_snapshot.h"
+
+// Очереди с узлами в пуле получают свежий пул на прогон, остальные пользуются общим пулом процесса
+template <typename Queue>
+Queue make_queue(node_pool& pool) {
+    if constexpr (std::is_constructible_v<Queue, node_pool&>) {
+        return Queue(pool);
+    }
+    else {
+        return Queue();
+    }
+}
+
+template <typename Run>
+double elapsed_ms(Run run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / 1000.0;
+}
+
+// Журнал вставок с повторяющимися строками задач, как после долгой работы очереди
+std::vector<std::pair<std::string, int>> make_journal(int count, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::vector<std::pair<std::string, int>> journal;
+    journal.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        journal.emplace_back("task-" + std::to_string(generator() % 100000), static_cast<int>(generator() >> 1));
+    }
+    return journal;
+}
+
+template <typename Queue>
+void compare_restart(const char* name, const std::vector<std::pair<std::string, int>>& journal, const char* path) {
+    node_pool source_pool;
+    Queue source = make_queue<Queue>(source_pool);
+    for (const auto& item : journal) {
+        source.add_value(item.first.c_str(), item.second);
+    }
+
+    double save_time = elapsed_ms([&] {
+        std::ofstream file(path, std::ios::binary);
+        save_snapshot(source, file);
+    });
+
+    node_pool replay_pool;
+    Queue replayed = make_queue<Queue>(replay_pool);
+    double replay_time = elapsed_ms([&] {
+        for (const auto& item : journal) {
+            replayed.add_value(item.first.c_str(), item.second);
+        }
+    });
+
+    node_pool restore_pool;
+    Queue restored = make_queue<Queue>(restore_pool);
+    double restore_time = elapsed_ms([&] {
+        mapped_snapshot snapshot(path);
+        load_snapshot(restored, snapshot.view());
+    });
+
+    bool same_top = restored.size() == replayed.size() &&
+                    std::strcmp(restored.search_value(), replayed.search_value()) == 0;
+    std::cout << "  " << name << ": replay " << replay_time << ", save " << save_time
+              << ", restore " << restore_time << ", same top: " << (same_top ? "true" : "false") << "\n";
+}
+
+// Снимок в памяти и работа после него: cycles раз очередь копируется, после чего в ней
+// делается mutations пар извлечение + вставка, а снимок живёт до следующего цикла.
+// Левосторонняя куча и декартово дерево разделяют узлы со снимком, остальные копируют все.
+// Время в микросекундах на цикл и число системных выделений пула за все циклы
+template <typename Queue>
+void compare_snapshot_cycles(const char* name, const std::vector<std::pair<std::string, int>>& journal,
+                             int cycles, int mutations) {
+    node_pool pool;
+    Queue queue(pool);
+    for (const auto& item : journal) {
+        queue.add_value(item.first.c_str(), item.second);
+    }
+
+    std::mt19937 generator(10);
+    std::size_t allocations = pool.system_allocations();
+    double snapshot_time = 0;
+    double mutate_time = 0;
+    {
+        Queue snapshot(pool);
+        for (int cycle = 0; cycle < cycles; ++cycle) {
+            snapshot_time += elapsed_ms([&] {
+                snapshot = queue;
+            });
+            mutate_time += elapsed_ms([&] {
+                for (int i = 0; i < mutations; ++i) {
+                    queue.delete_value();
+                    queue.add_value(journal[generator() % journal.size()].first.c_str(), static_cast<int>(generator() >> 1));
+                }
+            });
+        }
+    }
+
+    std::cout << "  " << name << ": snapshot " << snapshot_time * 1000 / cycles << ", mutate "
+              << mutate_time * 1000 / cycles << ", system allocations " << pool.system_allocations() - allocations << "\n";
+}
+
+// Снимок записей records в памяти; records_in_header подменяет число записей в заголовке
+std::string make_snapshot_bytes(std::uint32_t flags, const std::vector<std::pair<std::string, int>>& records,
+                                std::uint64_t records_in_header) {
+    std::ostringstream os;
+    snapshot_writer writer(os, static_cast<int>(records.size()), flags);
+    for (const auto& record : records) {
+        writer.add(record.first.c_str(), record.second);
+    }
+    writer.finish();
+
+    std::string bytes = os.str();
+    std::memcpy(&bytes[16], &records_in_header, sizeof(records_in_header));
+    return bytes;
+}
+
+// Загрузка повреждённого снимка: текст ошибки или вершина загруженной очереди
+std::string load_damaged(const std::string& bytes) {
+    try {
+        binary_priority_queue queue(snapshot_view(bytes.data(), bytes.size()));
+        return std::string("top ") + queue.search_value();
+    }
+    catch (const char* msg) {
+        return msg;
+    }
+}
+
+void check_damaged_snapshots() {
+    std::vector<std::pair<std::string, int>> records = { { "alpha", 1 }, { "beta", 2 }, { "gamma", 3 } };
+
+    std::cout << "\nDamaged snapshots\n";
+    std::cout << "----------------------------------------\n";
+    std::cout << "  heap flag on unordered records: "
+              << load_damaged(make_snapshot_bytes(snapshot_view::HEAP_ORDERED, records, 3)) << "\n";
+    std::cout << "  header claiming INT32_MAX records: "
+              << load_damaged(make_snapshot_bytes(0, {}, INT32_MAX)) << "\n";
+    std::cout << "  header claiming fewer records: "
+              << load_damaged(make_snapshot_bytes(0, records, 2)) << "\n";
+
+    std::string truncated = make_snapshot_bytes(0, records, 3);
+    truncated.resize(truncated.size() - (sizeof("gamma") + 8));
+    std::cout << "  header claiming more records: " << load_damaged(truncated) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = "snapshot_benchmark.bin";
+    try {
+        int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+        std::vector<std::pair<std::string, int>> journal = make_journal(count, 9);
+
+        std::cout << "Restart with " << count << " queued tasks (ms)\n";
+        std::cout << "----------------------------------------\n";
+        compare_restart<binary_priority_queue>("binary", journal, path);
+        compare_restart<binomial_priority_queue>("binomial", journal, path);
+        compare_restart<fibonacci_priority_queue>("fibonacci", journal, path);
+        compare_restart<leftist_priority_queue>("leftist", journal, path);
+        compare_restart<skew_priority_queue>("skew", journal, path);
+        compare_restart<treap_priority_queue>("treap", journal, path);
+        compare_restart<pairing_priority_queue>("pairing", journal, path);
+
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            std::cout << "Snapshot size: " << static_cast<double>(file.tellg()) / (1024 * 1024) << " MB\n";
+        }
+
+        std::cout << "\nSnapshot then 16 mutations, 100 cycles (us per cycle)\n";
+        std::cout << "----------------------------------------\n";
+        compare_snapshot_cycles<leftist_priority_queue>("leftist", journal, 100, 16);
+        compare_snapshot_cycles<treap_priority_queue>("treap", journal, 100, 16);
+        compare_snapshot_cycles<skew_priority_queue>("skew", journal, 100, 16);
+        compare_snapshot_cycles<pairing_priority_queue>("pairing", journal, 100, 16);
+
+        check_damaged_snapshots();
+    }
+    catch (const char* msg) {
+        std::cerr << "Error: " << msg << "\n";
+        std::remove(path);
+        return 1;
+    }
+
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef THROWING_COPY_VALUE_H
+#define THROWING_COPY_VALUE_H
+
+// Значение для проверок безопасности исключений в демонстрациях: копия бросает, когда
+// copies_left доходит до нуля (-1 - никогда); live считает живые экземпляры, чтобы
+// неудачная копия или слияние очереди не прятали утечку
+struct throwing_copy_value {
+    static inline int live = 0;
+    static inline int copies_left = -1;
+
+    throwing_copy_value() { ++live; }
+
+    throwing_copy_value(const throwing_copy_value&) {
+        if (copies_left >= 0 && copies_left-- == 0) throw "Copy failed";
+        ++live;
+    }
+
+    throwing_copy_value(throwing_copy_value&&) noexcept { ++live; }
+
+    ~throwing_copy_value() { --live; }
+};
+
+#endif //THROWING_COPY_VALUE_H
@@ -1,291 +1,733 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
-#include "C:\Users\arnau\source\repos\second_sem_labs\priority_queue.h"
-
-class treap_priority_queue final : public priority_queue {
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "5z.h"
+#include "node_pool.h"
+
+// Декартово дерево над произвольными значениями и приоритетами: ключ - порядок
+// вставки, приоритет задаёт кучу. Compare работает как в std::priority_queue:
+// std::less - в корне наибольший приоритет, std::greater - наименьший.
+// Ключ, возвращённый add_value, позволяет удалить элемент или сменить его приоритет
+// за высоту дерева; узлы хранят размер поддерева для порядковых запросов по ключу.
+// Случайной балансировки нет: форму дерева задают сами приоритеты, и высота O(log n)
+// только в среднем для случайных приоритетов. Монотонные приоритеты вытягивают дерево
+// в цепочку длины n, поэтому все обходы идут без рекурсии
+template <typename T, typename Priority = int, typename Compare = std::less<Priority>>
+class basic_treap_priority_queue {
 private:
+    // Узлы выделяются из node_pool и разделяются между копиями очереди:
+    // references - число указателей на узел (корни очередей и родители).
+    // shift - отложенная добавка к ключам всего поддерева, включая сам узел:
+    // настоящий ключ - key плюс сдвиги всех узлов пути от корня до узла
     struct Node {
-        char* value;
-        int priority;
+        T value;
+        Priority priority;
         int key;
+        int shift;
+        int size;
+        std::atomic<int> references;
         Node* left;
         Node* right;
 
-        Node(const char* str, int p, int k) : priority(p), key(k), left(nullptr), right(nullptr) {
-            if (str && std::strlen(str) > 0) {
-                value = new char[std::strlen(str) + 1];
-                std::strcpy(value, str);
+        template <typename Value>
+        Node(Value&& v, const Priority& p, int k)
+            : value(std::forward<Value>(v)), priority(p), key(k), shift(0), size(1), references(1), left(nullptr),
+              right(nullptr) {}
+
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+    };
+
+    Node* root;
+    int key_counter;
+    int node_count;
+    node_pool* pool;
+    Compare compare;
+
+private:
+    static Node* acquire(Node* node) {
+        if (node) node->references.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    // Атомарные счётчики ссылок, как в левосторонней куче
+    static bool is_shared(const Node* node) {
+        return node->references.load(std::memory_order_acquire) > 1;
+    }
+
+    static bool drop_reference(Node* node) {
+        return node->references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // Копирование при записи, как в левосторонней куче: разделённый узел перед изменением
+    // заменяется копией, разделяющей с ним поддеревья, так что split, merge_nodes и вставка
+    // копируют только пройденный путь длиной в высоту дерева.
+    // Очередь некопируемых значений скопировать нельзя, и её узлы никогда не разделены
+    Node* own(Node* node) const {
+        if constexpr (std::is_copy_constructible_v<T>) {
+            if (is_shared(node)) {
+                Node* copy = copy_node(node);
+                copy->left = acquire(node->left);
+                copy->right = acquire(node->right);
+                delete_tree(node);
+                return copy;
             }
-            else {
-                value = nullptr;
+        }
+        return node;
+    }
+
+    // Вершина перемещается из узла, только если её не видят другие копии очереди
+    [[nodiscard]] T take_top_value() {
+        if constexpr (std::is_copy_constructible_v<T>) {
+            if (is_shared(root)) return root->value;
+        }
+        return std::move(root->value);
+    }
+
+    static int size_of(const Node* node) {
+        return node ? node->size : 0;
+    }
+
+    static void update_size(Node* node) {
+        node->size = 1 + size_of(node->left) + size_of(node->right);
+    }
+
+    // Проталкивает сдвиг узла в детей. Узел должен принадлежать этой очереди; перед
+    // перевешиванием узла его сдвиг сбрасывается, иначе он достанется чужим поддеревьям
+    void push_down(Node* node) const {
+        if (node->shift == 0) return;
+
+        for (Node** child : { &node->left, &node->right }) {
+            if (*child) {
+                *child = own(*child);
+                (*child)->shift += node->shift;
             }
         }
+        node->key += node->shift;
+        node->shift = 0;
+    }
+
+    // Размеры вдоль цепочки, где каждый узел - ребёнок предыдущего по next, а по side
+    // висит нетронутое поддерево: размер узла - сумма 1 + size(side) от него до конца цепочки
+    static void resize_chain(Node* node, Node* Node::*next, Node* Node::*side) {
+        int total = 0;
+        for (Node* current = node; current; current = current->*next) {
+            total += 1 + size_of(current->*side);
+        }
+        for (Node* current = node; current; current = current->*next) {
+            current->size = total;
+            total -= 1 + size_of(current->*side);
+        }
+    }
 
-        Node(const Node& other) : priority(other.priority), key(other.key),
-            left(nullptr), right(nullptr) {
-            if (other.value) {
-                value = new char[std::strlen(other.value) + 1];
-                std::strcpy(value, other.value);
+    // Разрез по ключу сверху вниз без рекурсии: узлы с ключом не больше key образуют
+    // правый путь left, остальные - левый путь right; размеры пересчитываются по этим путям
+    void split(Node* current, int key, Node*& left, Node*& right) const {
+        Node** left_link = &left;
+        Node** right_link = &right;
+
+        while (current) {
+            current = own(current);
+            push_down(current);
+            if (current->key <= key) {
+                *left_link = current;
+                left_link = &current->right;
+                current = current->right;
             }
             else {
-                value = nullptr;
+                *right_link = current;
+                right_link = &current->left;
+                current = current->left;
             }
         }
+        *left_link = nullptr;
+        *right_link = nullptr;
 
-        Node& operator=(const Node& other) {
-            if (this != &other) {
-                delete[] value;
-                priority = other.priority;
-                key = other.key;
-                if (other.value) {
-                    value = new char[std::strlen(other.value) + 1];
-                    std::strcpy(value, other.value);
-                }
-                else {
-                    value = nullptr;
-                }
+        resize_chain(left, &Node::right, &Node::left);
+        resize_chain(right, &Node::left, &Node::right);
+    }
+
+    // Склейка деревьев, где все ключи left меньше ключей right, спуском по правому пути
+    // left и левому пути right. Узел пути получает под себя всё другое дерево целиком,
+    // поэтому его размер известен сразу
+    Node* merge_nodes(Node* left, Node* right) const {
+        Node* result = nullptr;
+        Node** link = &result;
+
+        while (left && right) {
+            if (compare(right->priority, left->priority)) {
+                left = own(left);
+                push_down(left);
+                left->size += right->size;
+                *link = left;
+                link = &left->right;
+                left = left->right;
+            }
+            else {
+                right = own(right);
+                push_down(right);
+                right->size += left->size;
+                *link = right;
+                link = &right->left;
+                right = right->left;
             }
-            return *this;
         }
+        *link = left ? left : right;
+
+        return result;
+    }
 
-        ~Node() {
-            delete[] value;
+    // Спуск по ключу до первого узла с худшим приоритетом; новый узел встаёт на его место
+    // и забирает его поддерево разрезом по своему ключу
+    Node* insert_node(Node* current, Node* new_node) const {
+        Node* result = current;
+        Node** link = &result;
+
+        while (*link && !compare((*link)->priority, new_node->priority)) {
+            Node* node = *link = own(*link);
+            push_down(node);
+            node->size++;
+            link = new_node->key < node->key ? &node->left : &node->right;
         }
-    };
 
-    Node* root;
-    int key_counter;
+        split(*link, new_node->key, new_node->left, new_node->right);
+        update_size(new_node);
+        *link = new_node;
 
-private:
-    void split(Node* current, int key, Node*& left, Node*& right) {
-        if (!current) {
-            left = right = nullptr;
-            return;
-        }
+        return result;
+    }
 
-        if (current->key <= key) {
-            split(current->right, key, current->right, right);
-            left = current;
+    // Поиск только читает дерево: отложенные сдвиги складываются по пути
+    [[nodiscard]] const Node* find_node(int key) const {
+        long long offset = 0;
+        for (const Node* node = root; node;) {
+            offset += node->shift;
+            long long node_key = node->key + offset;
+            if (node_key == key) return node;
+            node = key < node_key ? node->left : node->right;
         }
-        else {
-            split(current->left, key, left, current->left);
-            right = current;
+        return nullptr;
+    }
+
+    // Крайний ключ дерева: спуск по левому (first) или правому пути
+    [[nodiscard]] static int edge_key(const Node* node, bool first) {
+        long long offset = 0;
+        for (;;) {
+            offset += node->shift;
+            const Node* next = first ? node->left : node->right;
+            if (!next) return static_cast<int>(node->key + offset);
+            node = next;
         }
     }
 
-    Node* merge_nodes(Node* left, Node* right) {
-        if (!left) return right;
-        if (!right) return left;
+    // Вырезает узел с ключом key двумя разрезами и склеивает остатки обратно;
+    // возвращает узел со ссылкой от вызывающего или nullptr, если ключа нет
+    Node* detach(int key) {
+        if (!find_node(key)) return nullptr;
 
-        if (left->priority > right->priority) {
-            left->right = merge_nodes(left->right, right);
-            return left;
-        }
-        else {
-            right->left = merge_nodes(left, right->left);
-            return right;
-        }
+        Node* left;
+        Node* middle;
+        Node* right;
+        split(root, key - 1, left, middle);
+        split(middle, key, middle, right);
+        root = merge_nodes(left, right);
+        return middle;
     }
 
-    Node* insert_node(Node* current, Node* new_node) {
-        if (!current) return new_node;
+    Node* delete_root(Node* current) {
+        if (!current) return nullptr;
 
-        if (new_node->priority > current->priority) {
-            split(current, new_node->key, new_node->left, new_node->right);
-            return new_node;
+        // Сдвиг удаляемого корня достаётся его детям
+        if (current->shift != 0) {
+            current = own(current);
+            push_down(current);
         }
 
-        if (new_node->key < current->key) {
-            current->left = insert_node(current->left, new_node);
+        Node* left = current->left;
+        Node* right = current->right;
+        if (!is_shared(current)) {
+            current->left = current->right = nullptr;
+            pool->destroy(current);
         }
         else {
-            current->right = insert_node(current->right, new_node);
+            // Разделённый корень остаётся другим копиям, его дети получают ссылку от этой
+            acquire(left);
+            acquire(right);
+            delete_tree(current);
         }
-
-        return current;
+        return merge_nodes(left, right);
     }
 
-    Node* delete_root(Node* current) {
-        if (!current) return nullptr;
-        Node* result = merge_nodes(current->left, current->right);
-        current->left = current->right = nullptr;
-        delete current;
-        return result;
+    [[nodiscard]] Node* copy_node(const Node* source) const {
+        Node* node = pool->template create<Node>(source->value, source->priority, source->key);
+        node->shift = source->shift;
+        node->size = source->size;
+        return node;
     }
 
-    [[nodiscard]] Node* find_max_priority(Node* current) const {
-        if (!current) return nullptr;
+    // Копирование с явным стеком: высота дерева не ограничена. Если копия узла
+    // бросает исключение, уже скопированная часть освобождается
+    [[nodiscard]] Node* copy_tree(const Node* node) const {
+        if (!node) return nullptr;
+
+        Node* new_root = copy_node(node);
+        try {
+            std::vector<std::pair<const Node*, Node*>> pending;
+            pending.push_back({ node, new_root });
 
-        Node* max_node = current;
-        Node* left_max = find_max_priority(current->left);
-        Node* right_max = find_max_priority(current->right);
+            while (!pending.empty()) {
+                const Node* source = pending.back().first;
+                Node* target = pending.back().second;
+                pending.pop_back();
 
-        if (left_max && left_max->priority > max_node->priority) {
-            max_node = left_max;
+                if (source->left) {
+                    target->left = copy_node(source->left);
+                    pending.push_back({ source->left, target->left });
+                }
+                if (source->right) {
+                    target->right = copy_node(source->right);
+                    pending.push_back({ source->right, target->right });
+                }
+            }
         }
-        if (right_max && right_max->priority > max_node->priority) {
-            max_node = right_max;
+        catch (...) {
+            delete_tree(new_root);
+            throw;
         }
 
-        return max_node;
+        return new_root;
     }
 
-    Node* copy_tree(Node* node) {
-        if (!node) return nullptr;
-        Node* new_node = new Node(node->value, node->priority, node->key);
-        new_node->left = copy_tree(node->left);
-        new_node->right = copy_tree(node->right);
-        return new_node;
+    // Узлы другого пула разделять нельзя - их придётся вернуть в чужой пул
+    [[nodiscard]] Node* share_tree(const basic_treap_priority_queue& other) const {
+        return other.pool == pool ? acquire(other.root) : copy_tree(other.root);
     }
 
-    void delete_tree(Node* node) {
-        if (node) {
-            delete_tree(node->left);
-            delete_tree(node->right);
-            delete node;
+    // Снимает ссылку на дерево; узлы без ссылок удаляются поворотами, как в левосторонней
+    // куче. Живой ребёнок только теряет ссылку, его поддерево остаётся другим копиям
+    void delete_tree(Node* node) const {
+        if (!node || !drop_reference(node)) return;
+
+        node_pool::teardown<Node> batch(*pool);
+        while (node) {
+            if (Node* left = node->left) {
+                if (!drop_reference(left)) {
+                    node->left = nullptr;
+                    continue;
+                }
+                node->left = left->right;
+                node->references.store(1, std::memory_order_relaxed);
+                left->right = node;
+                node = left;
+            }
+            else {
+                Node* right = node->right;
+                batch.destroy(node);
+                node = right && drop_reference(right) ? right : nullptr;
+            }
         }
     }
 
-    [[nodiscard]] int count_nodes(Node* node) const {
-        if (!node) return 0;
-        return 1 + count_nodes(node->left) + count_nodes(node->right);
-    }
-
     [[nodiscard]] int calculate_height(Node* node) const {
-        if (!node) return 0;
-        int left_height = calculate_height(node->left);
-        int right_height = calculate_height(node->right);
-        return 1 + (left_height > right_height ? left_height : right_height);
+        int height = 0;
+        std::vector<std::pair<Node*, int>> pending;
+        if (node) pending.push_back({ node, 1 });
+
+        while (!pending.empty()) {
+            Node* current = pending.back().first;
+            int depth = pending.back().second;
+            pending.pop_back();
+
+            if (depth > height) height = depth;
+            if (current->left) pending.push_back({ current->left, depth + 1 });
+            if (current->right) pending.push_back({ current->right, depth + 1 });
+        }
+
+        return height;
     }
 
-    void print_tree(std::ostream& os, Node* node, int depth = 0) const {
+    void print_tree(std::ostream& os, Node* node, int depth = 0, long long offset = 0) const {
         if (!node) return;
-        print_tree(os, node->right, depth + 1);
+        offset += node->shift;
+        print_tree(os, node->right, depth + 1, offset);
 
         for (int i = 0; i < depth; ++i) {
             os << "    ";
         }
 
-        os << "[Key: " << node->key << ", Prio: " << node->priority
-            << ", Val: " << (node->value ? node->value : "null") << "]\n";
+        os << "[Key: " << node->key + offset << ", Prio: " << node->priority
+            << ", Val: " << node->value << "]\n";
 
-        print_tree(os, node->left, depth + 1);
+        print_tree(os, node->left, depth + 1, offset);
     }
 
 public:
-    treap_priority_queue() : root(nullptr), key_counter(0) {}
-
-    treap_priority_queue(const treap_priority_queue& other) : root(nullptr), key_counter(other.key_counter) {
-        if (other.root) {
-            root = copy_tree(other.root);
-        }
+    basic_treap_priority_queue() : basic_treap_priority_queue(node_pool::process_default()) {}
+
+    // Очереди, созданные с одним пулом, сливаются перемещением без копирования узлов
+    explicit basic_treap_priority_queue(node_pool& shared_pool, const Compare& order = Compare())
+        : root(nullptr), key_counter(0), node_count(0), pool(&shared_pool), compare(order) {}
+
+    // Копия - снимок за O(1): узлы разделяются, а последующие изменения любой из очередей
+    // копируют только пройденный путь
+    // Копию можно отдать другому потоку, если узлы лежат в общем пуле процесса
+    basic_treap_priority_queue(const basic_treap_priority_queue& other)
+        : root(acquire(other.root)), key_counter(other.key_counter), node_count(other.node_count),
+          pool(other.pool), compare(other.compare) {
+        static_assert(std::is_copy_constructible_v<T>, "queue copies share nodes and need copyable values");
     }
 
-    treap_priority_queue& operator=(const treap_priority_queue& other) {
+    basic_treap_priority_queue& operator=(const basic_treap_priority_queue& other) {
         if (this != &other) {
+            Node* copy = share_tree(other);
             delete_tree(root);
-            root = other.root ? copy_tree(other.root) : nullptr;
+            root = copy;
             key_counter = other.key_counter;
+            node_count = other.node_count;
+            compare = other.compare;
         }
         return *this;
     }
 
-    treap_priority_queue(treap_priority_queue&& other) noexcept
-        : root(other.root), key_counter(other.key_counter) {
+    basic_treap_priority_queue(basic_treap_priority_queue&& other) noexcept
+        : root(other.root), key_counter(other.key_counter), node_count(other.node_count),
+          pool(other.pool), compare(other.compare) {
         other.root = nullptr;
         other.key_counter = 0;
+        other.node_count = 0;
     }
 
-    treap_priority_queue& operator=(treap_priority_queue&& other) noexcept {
+    basic_treap_priority_queue& operator=(basic_treap_priority_queue&& other) noexcept {
         if (this != &other) {
             delete_tree(root);
             root = other.root;
             key_counter = other.key_counter;
+            node_count = other.node_count;
+            compare = other.compare;
+            pool = other.pool;
             other.root = nullptr;
             other.key_counter = 0;
+            other.node_count = 0;
         }
         return *this;
     }
 
-    ~treap_priority_queue() {
+    ~basic_treap_priority_queue() {
         delete_tree(root);
     }
 
-    void add_value(const char* str, int priority) override {
-        if (!str) throw "Null pointer";
-        if (std::strlen(str) == 0) throw "Empty string";
-
-        int new_key = key_counter++;
-        Node* new_node = new Node(str, priority, new_key);
+    // Возвращает ключ элемента. Ключи очереди-донора при merge перенумеровываются,
+    // поэтому выданные ею ключи после слияния недействительны
+    template <typename Value>
+    int add_value(Value&& value, const Priority& priority) {
+        int new_key = take_keys(1);
+        Node* new_node = pool->template create<Node>(std::forward<Value>(value), priority, new_key);
         root = insert_node(root, new_node);
+        node_count++;
+        return new_key;
     }
 
-    [[nodiscard]] const char* search_value() const override {
-        Node* max_node = find_max_priority(root);
-        if (!max_node) throw "Queue is empty";
-        return max_node->value;
+    // Удаление по ключу за высоту дерева; false, если элемент уже извлечён
+    bool erase(int key) {
+        Node* node = detach(key);
+        if (!node) return false;
+
+        delete_tree(node);
+        node_count--;
+        return true;
     }
 
-    void delete_value() override {
-        Node* max_node = find_max_priority(root);
-        if (!max_node) throw "Queue is empty";
+    // Смена приоритета в обе стороны: узел вырезается и вставляется заново по тому же ключу
+    bool change_priority(int key, const Priority& priority) {
+        Node* node = detach(key);
+        if (!node) return false;
 
-        if (root == max_node) {
-            root = delete_root(root);
+        node->priority = priority;
+        root = insert_node(root, node);
+        return true;
+    }
+
+    [[nodiscard]] bool contains(int key) const {
+        return find_node(key) != nullptr;
+    }
+
+    // Сколько элементов в очереди вставлено раньше элемента key: спуск по ключу
+    // с суммированием размеров левых поддеревьев, O(высоты)
+    [[nodiscard]] int count_inserted_before(int key) const {
+        int count = 0;
+        long long offset = 0;
+        for (const Node* node = root; node;) {
+            offset += node->shift;
+            long long node_key = node->key + offset;
+            if (key < node_key) {
+                node = node->left;
+            }
+            else {
+                count += size_of(node->left);
+                if (key == node_key) return count;
+                count++;
+                node = node->right;
+            }
         }
-        else {
-            root = delete_max_priority_node(root);
+        throw "Key not found";
+    }
+
+    // Сколько элементов стоит строго выше элемента key по приоритету. Такие узлы по свойству
+    // кучи образуют верхнюю часть дерева, поэтому обход от корня не заходит в поддеревья
+    // ниже элемента; поддерево, чей корень не выше key, пропускается целиком.
+    // Стоимость O(ответа + высоты), то есть до O(n) для элемента с низким приоритетом:
+    // размеры поддеревьев тут не помогают, поскольку дерево упорядочено по ключу, а не по приоритету
+    [[nodiscard]] int count_outranking(int key) const {
+        const Node* target = find_node(key);
+        if (!target) throw "Key not found";
+
+        int count = 0;
+        std::vector<const Node*> pending;
+        if (compare(target->priority, root->priority)) pending.push_back(root);
+
+        while (!pending.empty()) {
+            const Node* node = pending.back();
+            pending.pop_back();
+            count++;
+
+            for (const Node* child : { node->left, node->right }) {
+                if (child && compare(target->priority, child->priority)) {
+                    pending.push_back(child);
+                }
+            }
         }
+        return count;
     }
 
-private:
-    Node* delete_max_priority_node(Node* current) {
-        if (!current) return nullptr;
+    // Узлы упорядочены по priority как куча, поэтому вершина всегда в корне
+    [[nodiscard]] const T& search_value() const {
+        if (!root) throw "Queue is empty";
+        return root->value;
+    }
 
-        Node* max_node = find_max_priority(current);
-        if (!max_node) return current;
+    [[nodiscard]] const Priority& search_priority() const {
+        if (!root) throw "Queue is empty";
+        return root->priority;
+    }
 
-        if (current == max_node) {
-            return delete_root(current);
+    void delete_value() {
+        if (!root) throw "Queue is empty";
+        root = delete_root(root);
+        node_count--;
+    }
+
+    // Забирает значение с вершины перемещением и удаляет его из очереди
+    [[nodiscard]] T extract_value() {
+        if (!root) throw "Queue is empty";
+
+        T value = take_top_value();
+        delete_value();
+        return value;
+    }
+
+protected:
+    // Пакетная вставка за O(n): ключи новых узлов больше всех прежних, поэтому узлы
+    // встают на правый путь дерева. Стек хранит этот путь; новый узел поднимается над
+    // узлами с худшим приоритетом и забирает их как левое поддерево.
+    // make_value превращает первый элемент пары в значение очереди
+    template <typename InputIt, typename MakeValue>
+    void append_range(InputIt first, InputIt last, MakeValue make_value) {
+        // Узлы правого пути получат новых детей, поэтому разделённые копируются заранее
+        std::vector<Node*> right_path;
+        for (Node** link = &root; *link; link = &(*link)->right) {
+            *link = own(*link);
+            push_down(*link);
+            right_path.push_back(*link);
         }
 
-        if (max_node->key < current->key) {
-            current->left = delete_max_priority_node(current->left);
+        // Снятый с пути узел больше не получит детей: его размер пересчитывается
+        // снизу вверх, а оставшийся путь пересчитывается в конце, в том числе при исключении
+        auto finish_path = [&right_path]() {
+            Node* node = right_path.back();
+            right_path.pop_back();
+            update_size(node);
+            return node;
+        };
+
+        try {
+            for (; first != last; ++first) {
+                int key = take_keys(1);
+                Node* node = pool->template create<Node>(make_value(first->first), first->second, key);
+                node_count++;
+
+                Node* lifted = nullptr;
+                while (!right_path.empty() && compare(right_path.back()->priority, node->priority)) {
+                    lifted = finish_path();
+                }
+
+                node->left = lifted;
+                if (right_path.empty()) {
+                    root = node;
+                }
+                else {
+                    right_path.back()->right = node;
+                }
+                right_path.push_back(node);
+            }
         }
-        else {
-            current->right = delete_max_priority_node(current->right);
+        catch (...) {
+            while (!right_path.empty()) finish_path();
+            throw;
         }
-
-        return current;
+        while (!right_path.empty()) finish_path();
     }
 
 public:
-    priority_queue& merge(const priority_queue& second) override {
-        const treap_priority_queue* other_queue =
-            dynamic_cast<const treap_priority_queue*>(&second);
+    // Пакетная вставка пар (значение, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [](const auto& value) -> const auto& { return value; });
+    }
 
-        if (!other_queue) {
-            throw "Incompatible queue types for merge";
+    // Обход всех элементов в порядке ключей (порядке вставки) с явным стеком: visit(value, priority).
+    // Снимок, загруженный через add_range, получает ключи в том же порядке
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        std::vector<const Node*> pending;
+        const Node* node = root;
+
+        while (node || !pending.empty()) {
+            for (; node; node = node->left) {
+                pending.push_back(node);
+            }
+            node = pending.back();
+            pending.pop_back();
+            visit(node->value, node->priority);
+            node = node->right;
+        }
+    }
+
+    // Пакетное извлечение: до count элементов с вершины в порядке очереди передаются
+    // consume(value, priority) перемещением; возвращает их число
+    template <typename Consume>
+    int pop_batch(int count, Consume consume) {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        int taken = 0;
+        for (; taken < count && root; ++taken) {
+            consume(take_top_value(), root->priority);
+            delete_value();
+        }
+        return taken;
+    }
+
+    // До count старших элементов без изменения очереди передаются visit(value, priority).
+    // Обход по фронту от корня: выданный узел добавляет во фронт обоих детей,
+    // поэтому стоимость O(count log count) и не зависит от размера очереди
+    template <typename Visit>
+    int top_k(int count, Visit visit) const {
+        if (count < 0) throw "Invalid count: must be non-negative";
+
+        auto lower = [this](const Node* first, const Node* second) {
+            return compare(first->priority, second->priority);
+        };
+        std::vector<const Node*> frontier;
+        if (count > 0 && root) {
+            frontier.reserve(std::min<std::size_t>(count, node_count) + 1);
+            frontier.push_back(root);
+        }
+
+        int visited = 0;
+        while (visited < count && !frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), lower);
+            const Node* node = frontier.back();
+            frontier.pop_back();
+            visit(node->value, node->priority);
+            ++visited;
+
+            for (const Node* child : { node->left, node->right }) {
+                if (child) {
+                    frontier.push_back(child);
+                    std::push_heap(frontier.begin(), frontier.end(), lower);
+                }
+            }
         }
+        return visited;
+    }
+
+    basic_treap_priority_queue& merge(const basic_treap_priority_queue& other) {
+        // Копия строится в своём пуле, чтобы дальше слить её перемещением
+        basic_treap_priority_queue donor(*pool, compare);
+        donor = other;
+        return merge(std::move(donor));
+    }
 
-        treap_priority_queue temp;
-        copy_and_merge(*other_queue, temp);
-        root = merge_nodes(root, temp.root);
-        temp.root = nullptr;
+    // Слияние без копирования значений: ключи донора сдвигаются за ключи этой очереди
+    // отложенным сдвигом в его корне, после чего деревья склеиваются как левое и правое
+    // поддеревья по ключу. Слияние стоит O(высоты). Счётчик растёт на разброс ключей
+    // донора, а если ключи донора разрежены (больше двух на элемент), они один раз
+    // перенумеровываются подряд за O(m), поэтому повторные слияния не раздувают ключи
+    basic_treap_priority_queue& merge(basic_treap_priority_queue&& other) {
+        if (&other == this) return *this;
+
+        // Узлы чужого пула нельзя вернуть в свой: копируем и очищаем донора
+        if (other.pool != pool) {
+            merge(static_cast<const basic_treap_priority_queue&>(other));
+            other = basic_treap_priority_queue(*other.pool, other.compare);
+            return *this;
+        }
+
+        if (other.root) {
+            long long low = edge_key(other.root, true);
+            long long span = edge_key(other.root, false) - low + 1;
+            if (span <= 2LL * other.node_count) {
+                int first = take_keys(static_cast<int>(span));
+                other.root = own(other.root);
+                other.root->shift += static_cast<int>(first - low);
+            }
+            else {
+                renumber_keys(other.root, take_keys(other.node_count));
+            }
+        }
+        root = merge_nodes(root, other.root);
+        node_count += other.node_count;
 
+        other.root = nullptr;
+        other.key_counter = 0;
+        other.node_count = 0;
         return *this;
     }
 
 private:
-    void copy_and_merge(const treap_priority_queue& other, treap_priority_queue& result) {
-        copy_with_new_keys(other.root, result);
+    // Выдаёт count ключей подряд; исключение раньше, чем счётчик переполнится
+    int take_keys(int count) {
+        if (count > INT_MAX - key_counter) throw "Key counter overflow";
+        int first = key_counter;
+        key_counter += count;
+        return first;
     }
 
-    void copy_with_new_keys(Node* node, treap_priority_queue& result) const{
-        if (!node) return;
-        result.add_value(node->value, node->priority);
-        copy_with_new_keys(node->left, result);
-        copy_with_new_keys(node->right, result);
+    // Ключи дерева становятся first, first + 1, ... в прежнем порядке: ключ узла - first
+    // плюс число узлов левее него, которое известно из размеров поддеревьев.
+    // Перенумерация меняет каждый узел, поэтому разделённые узлы донора копируются целиком
+    void renumber_keys(Node*& node, int first) {
+        std::vector<std::pair<Node**, int>> pending;
+        if (node) pending.push_back({ &node, first });
+
+        while (!pending.empty()) {
+            Node** link = pending.back().first;
+            int base = pending.back().second;
+            pending.pop_back();
+            Node* current = *link = own(*link);
+            current->key = base + size_of(current->left);
+            current->shift = 0;
+
+            if (current->left) pending.push_back({ &current->left, base });
+            if (current->right) pending.push_back({ &current->right, current->key + 1 });
+        }
     }
 
 public:
@@ -294,28 +736,30 @@ public:
     }
 
     [[nodiscard]] int get_size() const {
-        return count_nodes(root);
+        return node_count;
     }
 
-    [[nodiscard]] int get_height() const {
-        return calculate_height(root);
+    [[nodiscard]] int size() const {
+        return node_count;
     }
 
-    [[nodiscard]] treap_priority_queue meld(const treap_priority_queue& other) const {
-        treap_priority_queue result;
-
-        if (root) {
-            copy_with_new_keys(root, result);
-        }
+    [[nodiscard]] node_pool& get_pool() const {
+        return *pool;
+    }
 
-        if (other.root) {
-            copy_with_new_keys(other.root, result);
-        }
+    [[nodiscard]] int get_height() const {
+        return calculate_height(root);
+    }
 
+    [[nodiscard]] basic_treap_priority_queue meld(const basic_treap_priority_queue& other) const {
+        basic_treap_priority_queue result(*this);
+        basic_treap_priority_queue donor(*pool, compare);
+        donor = other;
+        result.merge(std::move(donor));
         return result;
     }
 
-    friend void print_treap_queue(const treap_priority_queue& queue, const char* name) {
+    friend void print_treap_queue(const basic_treap_priority_queue& queue, const char* name) {
         std::cout << name << " (size: " << queue.get_size()
             << ", height: " << queue.get_height() << "):\n";
 
@@ -329,7 +773,108 @@ public:
     }
 };
 
+// Реализация интерфейса priority_queue: строки интернируются в пуле очереди
+class treap_priority_queue final : public basic_treap_priority_queue<pooled_string>, public priority_queue {
+    using base = basic_treap_priority_queue<pooled_string>;
+
+    pooled_string intern(const char* str) const {
+        if (!str) throw "Null pointer";
+        if (std::strlen(str) == 0) throw "Empty string";
+        return pooled_string(get_pool().intern(str));
+    }
+
+    pooled_string intern(const std::string& str) const {
+        return intern(str.c_str());
+    }
+
+public:
+    using base::base;
+
+    void add_value(const char* str, int priority) override {
+        insert_value(str, priority);
+    }
+
+    // Вставка с ключом для erase, change_priority и порядковых запросов
+    int insert_value(const char* str, int priority) {
+        return base::add_value(intern(str), priority);
+    }
+
+    // Пакетная вставка пар (строка, приоритет)
+    template <typename InputIt>
+    void add_range(InputIt first, InputIt last) {
+        append_range(first, last, [this](const auto& str) { return intern(str); });
+    }
+
+    [[nodiscard]] const char* search_value() const override {
+        return base::search_value().c_str();
+    }
+
+    void delete_value() override {
+        base::delete_value();
+    }
+
+    bool try_peek(const char*& str, int& priority) const override {
+        if (base::is_empty()) return false;
+        str = base::search_value().c_str();
+        priority = base::search_priority();
+        return true;
+    }
+
+    bool try_pop(std::string& str, int& priority) override {
+        return base::pop_batch(1, [&str, &priority](const pooled_string& value, int top_priority) {
+            str = value.c_str();
+            priority = top_priority;
+        }) == 1;
+    }
+
+    [[nodiscard]] int size() const override {
+        return base::size();
+    }
+
+    int pop_batch(int count, std::vector<std::pair<std::string, int>>& out) override {
+        return base::pop_batch(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    int top_k(int count, std::vector<std::pair<std::string, int>>& out) const override {
+        return base::top_k(count, [&out](const pooled_string& value, int priority) {
+            out.emplace_back(value.c_str(), priority);
+        });
+    }
+
+    priority_queue& merge(const priority_queue& second) override {
+        const treap_priority_queue* other_queue =
+            dynamic_cast<const treap_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<const base&>(*other_queue));
+        return *this;
+    }
+
+    priority_queue& merge(priority_queue&& second) override {
+        treap_priority_queue* other_queue = dynamic_cast<treap_priority_queue*>(&second);
+
+        if (!other_queue) {
+            throw "Incompatible queue types for merge";
+        }
+
+        base::merge(static_cast<base&&>(*other_queue));
+        return *this;
+    }
+
+    [[nodiscard]] treap_priority_queue meld(const treap_priority_queue& other) const {
+        treap_priority_queue result(get_pool());
+        static_cast<base&>(result) = base::meld(other);
+        return result;
+    }
+};
+
 // Демонстрация работы декартова дерева
+#ifndef PRIORITY_QUEUE_NO_DEMO
 int main() {
     try {
         std::cout << "Basic operations\n";
@@ -432,6 +977,46 @@ int main() {
         const char* interface_max = interface_ptr->search_value();
         std::cout << "Max via interface: " << interface_max << "\n";
 
+        std::cout << "\nCancel and re-prioritize by key\n";
+        std::cout << "----------------------------------\n";
+
+        {
+            treap_priority_queue jobs;
+            int build = jobs.insert_value("build", 50);
+            int deploy = jobs.insert_value("deploy", 40);
+            int lint = jobs.insert_value("lint", 30);
+            jobs.insert_value("test", 45);
+
+            std::cout << "Ahead of lint by priority: " << jobs.count_outranking(lint) << "\n";
+            std::cout << "Queued before lint: " << jobs.count_inserted_before(lint) << "\n";
+
+            jobs.erase(build);
+            jobs.change_priority(lint, 60);
+            std::cout << "Erase missing key: " << (jobs.erase(build) ? "true" : "false") << "\n";
+            std::cout << "Ahead of deploy after changes: " << jobs.count_outranking(deploy) << "\n";
+            print_treap_queue(jobs, "Jobs after cancelling build and raising lint");
+        }
+
+        std::cout << "\nMonotone insert regression\n";
+        std::cout << "----------------------------------\n";
+
+        // Возрастающие приоритеты вытягивают дерево в левую цепочку: разрез и склейка
+        // по самому глубокому ключу проходят её целиком
+        {
+            const int monotone_count = 1000000;
+            treap_priority_queue monotone_queue;
+            int oldest = monotone_queue.insert_value("tick", 0);
+            for (int i = 1; i < monotone_count; ++i) {
+                monotone_queue.add_value("tick", i);
+            }
+            std::cout << "Height after increasing priorities: " << monotone_queue.get_height() << "\n";
+
+            monotone_queue.change_priority(oldest, monotone_count);
+            std::cout << "Top priority after raising the oldest: " << monotone_queue.search_priority() << "\n";
+            monotone_queue.erase(oldest);
+            monotone_queue.delete_value();
+            std::cout << "Size after erase and pop: " << monotone_queue.get_size() << "\n";
+        }
         std::cout << "\nLarge operations test\n";
         std::cout << "-----------------------------\n";
 
@@ -445,6 +1030,29 @@ int main() {
         print_treap_queue(large_queue, "Large queue with 5 tasks");
         std::cout << "Large queue height: " << large_queue.get_height() << "\n";
 
+        std::cout << "\nPop cost scaling\n";
+        std::cout << "------------------------\n";
+
+        // При случайных приоритетах стоимость delete_value должна расти как O(log n) -
+        // по глубине слияния поддеревьев корня
+        std::mt19937 generator(12345);
+        const int pops_per_size = 1000;
+        for (int size = 1000; size <= 10000000; size *= 10) {
+            treap_priority_queue bench_queue;
+            for (int i = 0; i < size; ++i) {
+                bench_queue.add_value("job", static_cast<int>(generator()));
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < pops_per_size; ++i) {
+                bench_queue.delete_value();
+            }
+            auto finish = std::chrono::steady_clock::now();
+
+            auto total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+            std::cout << "  n = " << size << ": " << total_ns / pops_per_size << " ns/pop\n";
+        }
+
     }
     catch (const char* msg) {
         std::cerr << "Error: " << msg << "\n";
@@ -453,3 +1061,4 @@ int main() {
 
     return 0;
 }
+#endif